@@ -0,0 +1,840 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+
+// --MACROS
+// same as in RedBlackTree.h, the header doesn't need anything else from there
+// --PARAM: x is the value that will be tested if null, ... is an optional return
+#ifndef isNullptr
+#define isNullptr(x, ...) if(x == nullptr) return __VA_ARGS__;
+#endif
+
+// a B+ tree with the same interface as RedBlackTree
+// every node holds a few cache lines worth of values instead of one, so a search only touches
+// a handful of nodes, and the leaves are linked together so range scans walk them in order
+// T has to be default constructible as well as compareable since the nodes hold arrays of it
+
+template<class T>
+class BPlusNodeT
+{
+public:
+
+	// values a node can hold, enough to fill 4 cache lines but always even and at least 8
+	static const int capacity = (256 / sizeof(T) < 8) ? 8 : (int)(256 / sizeof(T)) / 2 * 2;
+
+	// variables to keep track of the node
+	bool isLeaf;
+	int count;
+	T keys[capacity];
+
+	// init the vars
+	BPlusNodeT(bool leaf)
+		:isLeaf(leaf), count(0)
+	{};
+
+	// every node but the root has to hold at least this many values
+	// an inner node gives one of its values to the parent when it splits so it is allowed one less
+	int minimum() const
+	{
+		return isLeaf ? capacity / 2 : capacity / 2 - 1;
+	};
+
+};
+
+// leaves hold the values and a link to the next leaf
+template<class T>
+class BPlusLeafT : public BPlusNodeT<T>
+{
+public:
+
+	BPlusLeafT<T>* next;
+
+	// init the vars
+	BPlusLeafT()
+		:BPlusNodeT<T>(true), next(nullptr)
+	{};
+
+};
+
+// inner nodes hold count separators and count + 1 children, everything in children[i]
+// is less than keys[i] and everything in children[i + 1] is at least keys[i]
+template<class T>
+class BPlusInnerT : public BPlusNodeT<T>
+{
+public:
+
+	BPlusNodeT<T>* children[BPlusNodeT<T>::capacity + 1];
+
+	// init the vars
+	BPlusInnerT()
+		:BPlusNodeT<T>(false)
+	{};
+
+};
+
+template<class T>
+class BPlusTree
+{
+public:
+
+	// constructor
+	BPlusTree();
+
+	// copy constructor
+	// creates a deep copy
+	BPlusTree(const BPlusTree<T>& copyBPT);
+
+	// operator=
+	// deeps copys and deallocates dynamic memory
+	BPlusTree<T>& operator=(const BPlusTree<T>& copyBPT);
+
+	// destructor
+	// deallocates dynamic memory allocated by the tree
+	~BPlusTree();
+
+	// inserts its template type parameter into the tree
+	bool insert(T value);
+
+	// remove's its template type parameter from the tree
+	bool remove(T value);
+
+	// search if value is in the tree and return true if found otherwise false
+	bool search(T value) const;
+
+	// search the tree for values in a specific range and returm a vector of T types
+	std::vector<T> search(T begin, T end) const;
+
+	// returns the largest value stored in the tree that is less than the method's single template parameter
+	T closestLess(T value) const;
+
+	// returns the smallest value stored in the tree that is greater than the method's single template parameter
+	T closestGreater(T value) const;
+
+	// returns a vector with all the values in the tree
+	std::vector<T> values() const;
+
+	// return the tree size
+	int size() const;
+
+private:
+
+	// variables
+	// tree root
+	BPlusNodeT<T>* root;
+
+	// tree size
+	int currentSize;
+
+	// --HELPERS =================================================================================================
+
+	// recursive function to copy all the values in the tree
+	// --PARAM: lastLeaf is the last leaf copied so far, the new leaves are linked onto it
+	BPlusNodeT<T>* copyHelper(BPlusNodeT<T>* copy, BPlusLeafT<T>*& lastLeaf);
+
+	// clear the whole tree
+	void clearTreeHelper(BPlusNodeT<T>* nd);
+
+	// delete a node as the type it really is
+	void deleteNode(BPlusNodeT<T>* nd);
+
+	// find the leaf the value belongs in
+	BPlusLeafT<T>* findLeaf(T value) const;
+
+	// recursive insert, a full node is split before the value goes in
+	// --PARAM: if nd had to split, splitKey and splitNode are set to the new right half and its smallest value
+	bool insertHelper(BPlusNodeT<T>* nd, T value, T& splitKey, BPlusNodeT<T>*& splitNode);
+
+	// recursive remove, a child that drops below the minimum borrows from or merges with a sibling
+	bool removeHelper(BPlusNodeT<T>* nd, T value);
+
+	// refill parent's i'th child from one of its siblings
+	void fixUnderflow(BPlusInnerT<T>* parent, int i);
+
+	// merge parent's (i + 1)'th child into its i'th child
+	void mergeChildren(BPlusInnerT<T>* parent, int i);
+
+	// index of the child of nd the value belongs in
+	static int childIndex(BPlusNodeT<T>* nd, T value);
+};
+
+
+template<class T>
+BPlusTree<T>::BPlusTree()
+{
+	// init the root and set the size
+	root = nullptr;
+	currentSize = 0;
+}
+
+template<class T>
+BPlusTree<T>::BPlusTree(const BPlusTree<T>& copyBPT)
+{
+	// copy the size from the param
+	currentSize = copyBPT.currentSize;
+
+	// call the recurisve method and assign it to the root
+	BPlusLeafT<T>* lastLeaf = nullptr;
+	root = copyHelper(copyBPT.root, lastLeaf);
+}
+
+template<class T>
+BPlusTree<T>& BPlusTree<T>::operator=(const BPlusTree<T>& copyBPT)
+{
+	// check if the param is self
+	if (this != &copyBPT)
+	{
+		// clear the tree
+		clearTreeHelper(root);
+
+		// copy the size from the param
+		currentSize = copyBPT.currentSize;
+
+		// call the recurisve method and assign it to the root
+		BPlusLeafT<T>* lastLeaf = nullptr;
+		root = copyHelper(copyBPT.root, lastLeaf);
+	}
+
+	return *this;
+}
+
+template<class T>
+BPlusTree<T>::~BPlusTree()
+{
+	// call the method to clear the tree recursively
+	clearTreeHelper(root);
+
+	// set size to 0
+	currentSize = 0;
+}
+
+template<class T>
+bool BPlusTree<T>::insert(T value)
+{
+	// the first value starts a leaf which is the root
+	if (root == nullptr)
+	{
+		root = new BPlusLeafT<T>();
+	}
+
+	T splitKey = value;
+	BPlusNodeT<T>* splitNode = nullptr;
+
+	// returns false if the value is in the tree already. This is to prevent duplication
+	if (!insertHelper(root, value, splitKey, splitNode))
+	{
+		return false;
+	}
+
+	// the root split so the tree grows a level
+	if (splitNode != nullptr)
+	{
+		BPlusInnerT<T>* newRoot = new BPlusInnerT<T>();
+		newRoot->keys[0] = splitKey;
+		newRoot->children[0] = root;
+		newRoot->children[1] = splitNode;
+		newRoot->count = 1;
+		root = newRoot;
+	}
+
+	// increase the size
+	currentSize++;
+
+	return true;
+}
+
+template<class T>
+bool BPlusTree<T>::remove(T value)
+{
+	// if there is no tree return false
+	isNullptr(root, false);
+
+	// otherwise the value is not in the tree
+	if (!removeHelper(root, value))
+	{
+		return false;
+	}
+
+	// decrease the tree size
+	currentSize--;
+
+	// an empty leaf root goes and an inner root with a single child hands the root down
+	if (root->count == 0)
+	{
+		BPlusNodeT<T>* oldRoot = root;
+
+		if (root->isLeaf)
+		{
+			root = nullptr;
+		}
+		else
+		{
+			root = static_cast<BPlusInnerT<T>*>(oldRoot)->children[0];
+		}
+
+		deleteNode(oldRoot);
+	}
+
+	return true;
+}
+
+template<class T>
+bool BPlusTree<T>::search(T value) const
+{
+	// find the leaf the value would be in
+	BPlusLeafT<T>* leaf = findLeaf(value);
+
+	// if there is no tree return false
+	isNullptr(leaf, false);
+
+	// search the leaf
+	const T* it = std::lower_bound(leaf->keys, leaf->keys + leaf->count, value);
+
+	return it != leaf->keys + leaf->count && *it == value;
+}
+
+template<class T>
+std::vector<T> BPlusTree<T>::search(T begin, T end) const
+{
+	// create a vector with T types
+	std::vector<T> results;
+
+	// second is bigger so we flip
+	if (end < begin)
+	{
+		T swapTemp = begin;
+		begin = end;
+		end = swapTemp;
+	}
+
+	// start in the leaf begin would be in
+	BPlusLeafT<T>* leaf = findLeaf(begin);
+
+	// if there is no tree return an empty vector
+	isNullptr(leaf, results);
+
+	int i = (int)(std::lower_bound(leaf->keys, leaf->keys + leaf->count, begin) - leaf->keys);
+
+	// walk the leaves in order until a value passes end
+	while (leaf != nullptr)
+	{
+		for (; i < leaf->count; i++)
+		{
+			if (end < leaf->keys[i])
+			{
+				return results;
+			}
+
+			results.push_back(leaf->keys[i]);
+		}
+
+		leaf = leaf->next;
+		i = 0;
+	}
+
+	// return the vector when finished
+	return results;
+}
+
+template<class T>
+T BPlusTree<T>::closestLess(T value) const // returns the largest value that is smaller then value
+{
+	// checks if root is a nullptr if so return an empty value
+	isNullptr(root, value);
+
+	// descend, remembering the closest subtree to the left of the path
+	BPlusNodeT<T>* nd = root;
+	BPlusNodeT<T>* leftOfPath = nullptr;
+
+	while (!nd->isLeaf)
+	{
+		int i = childIndex(nd, value);
+		BPlusInnerT<T>* inner = static_cast<BPlusInnerT<T>*>(nd);
+
+		if (i > 0)
+		{
+			leftOfPath = inner->children[i - 1];
+		}
+
+		nd = inner->children[i];
+	}
+
+	// value is found in this leaf
+	int i = (int)(std::lower_bound(nd->keys, nd->keys + nd->count, value) - nd->keys);
+
+	if (i > 0)
+	{
+		return nd->keys[i - 1];
+	}
+
+	// value is not found
+	isNullptr(leftOfPath, value);
+
+	// otherwise it's the largest value of the subtree to the left
+	while (!leftOfPath->isLeaf)
+	{
+		leftOfPath = static_cast<BPlusInnerT<T>*>(leftOfPath)->children[leftOfPath->count];
+	}
+
+	return leftOfPath->keys[leftOfPath->count - 1];
+}
+
+template<class T>
+T BPlusTree<T>::closestGreater(T value) const // returns the smallest value that is greater then value
+{
+	// find the leaf the value would be in
+	BPlusLeafT<T>* leaf = findLeaf(value);
+
+	// checks if root is a nullptr if so return an empty value
+	isNullptr(leaf, value);
+
+	// value is found in this leaf
+	int i = (int)(std::upper_bound(leaf->keys, leaf->keys + leaf->count, value) - leaf->keys);
+
+	if (i < leaf->count)
+	{
+		return leaf->keys[i];
+	}
+
+	// value is not found
+	isNullptr(leaf->next, value);
+
+	// otherwise it's the first value of the next leaf
+	return leaf->next->keys[0];
+}
+
+template<class T>
+std::vector<T> BPlusTree<T>::values() const
+{
+	// create a vector with T type's
+	std::vector<T> res;
+
+	// check if the root is nullptr
+	// if so return an empty vector
+	isNullptr(root, res);
+
+	res.reserve(currentSize);
+
+	// go down to the first leaf
+	BPlusNodeT<T>* nd = root;
+
+	while (!nd->isLeaf)
+	{
+		nd = static_cast<BPlusInnerT<T>*>(nd)->children[0];
+	}
+
+	// and walk the leaves in order
+	for (BPlusLeafT<T>* leaf = static_cast<BPlusLeafT<T>*>(nd); leaf != nullptr; leaf = leaf->next)
+	{
+		res.insert(res.end(), leaf->keys, leaf->keys + leaf->count);
+	}
+
+	// return the vector
+	return res;
+}
+
+template<class T>
+int BPlusTree<T>::size() const
+{
+	// return the tree size
+	return currentSize;
+}
+
+// --Helpers =======================================================================================
+
+template<class T>
+BPlusNodeT<T>* BPlusTree<T>::copyHelper(BPlusNodeT<T>* copy, BPlusLeafT<T>*& lastLeaf)
+{
+	// check if the param is a nullptr
+	// if so return the param
+	isNullptr(copy, copy);
+
+	// leaves are copied and linked onto the last leaf, in order
+	if (copy->isLeaf)
+	{
+		BPlusLeafT<T>* newLeaf = new BPlusLeafT<T>(*static_cast<BPlusLeafT<T>*>(copy));
+		newLeaf->next = nullptr;
+
+		if (lastLeaf != nullptr)
+		{
+			lastLeaf->next = newLeaf;
+		}
+
+		lastLeaf = newLeaf;
+		return newLeaf;
+	}
+
+	// inner nodes copy the separators and then every child
+	BPlusInnerT<T>* inner = static_cast<BPlusInnerT<T>*>(copy);
+	BPlusInnerT<T>* newInner = new BPlusInnerT<T>();
+	newInner->count = inner->count;
+
+	for (int i = 0; i < inner->count; i++)
+	{
+		newInner->keys[i] = inner->keys[i];
+	}
+
+	for (int i = 0; i <= inner->count; i++)
+	{
+		newInner->children[i] = copyHelper(inner->children[i], lastLeaf);
+	}
+
+	// return the newInner
+	return newInner;
+}
+
+template<class T>
+void BPlusTree<T>::clearTreeHelper(BPlusNodeT<T>* nd)
+{
+	// check if the param is null if so return
+	isNullptr(nd);
+
+	// go through the tree
+	if (!nd->isLeaf)
+	{
+		BPlusInnerT<T>* inner = static_cast<BPlusInnerT<T>*>(nd);
+
+		for (int i = 0; i <= inner->count; i++)
+		{
+			clearTreeHelper(inner->children[i]);
+		}
+	}
+
+	// and delete each node
+	deleteNode(nd);
+}
+
+template<class T>
+void BPlusTree<T>::deleteNode(BPlusNodeT<T>* nd)
+{
+	if (nd->isLeaf)
+	{
+		delete static_cast<BPlusLeafT<T>*>(nd);
+	}
+	else
+	{
+		delete static_cast<BPlusInnerT<T>*>(nd);
+	}
+}
+
+template<class T>
+BPlusLeafT<T>* BPlusTree<T>::findLeaf(T value) const
+{
+	// create a traverse pointer
+	BPlusNodeT<T>* nd = root;
+
+	// check if there is a tree
+	isNullptr(nd, nullptr);
+
+	// follow the separators down to a leaf
+	while (!nd->isLeaf)
+	{
+		nd = static_cast<BPlusInnerT<T>*>(nd)->children[childIndex(nd, value)];
+	}
+
+	return static_cast<BPlusLeafT<T>*>(nd);
+}
+
+template<class T>
+int BPlusTree<T>::childIndex(BPlusNodeT<T>* nd, T value)
+{
+	// the first separator bigger than the value
+	return (int)(std::upper_bound(nd->keys, nd->keys + nd->count, value) - nd->keys);
+}
+
+template<class T>
+bool BPlusTree<T>::insertHelper(BPlusNodeT<T>* nd, T value, T& splitKey, BPlusNodeT<T>*& splitNode)
+{
+	const int capacity = BPlusNodeT<T>::capacity;
+
+	if (nd->isLeaf)
+	{
+		BPlusLeafT<T>* leaf = static_cast<BPlusLeafT<T>*>(nd);
+
+		// if the value is in the leaf return false
+		T* it = std::lower_bound(leaf->keys, leaf->keys + leaf->count, value);
+
+		if (it != leaf->keys + leaf->count && *it == value)
+		{
+			return false;
+		}
+
+		// a full leaf hands its upper half to a new leaf linked in after it
+		if (leaf->count == capacity)
+		{
+			BPlusLeafT<T>* newLeaf = new BPlusLeafT<T>();
+			int half = capacity / 2;
+
+			for (int i = half; i < capacity; i++)
+			{
+				newLeaf->keys[i - half] = leaf->keys[i];
+			}
+
+			newLeaf->count = capacity - half;
+			leaf->count = half;
+
+			newLeaf->next = leaf->next;
+			leaf->next = newLeaf;
+
+			splitKey = newLeaf->keys[0];
+			splitNode = newLeaf;
+
+			// the value goes into whichever half it belongs in
+			if (!(value < splitKey))
+			{
+				leaf = newLeaf;
+			}
+		}
+
+		// shift the bigger values over and put the value in
+		int pos = (int)(std::lower_bound(leaf->keys, leaf->keys + leaf->count, value) - leaf->keys);
+
+		for (int i = leaf->count; i > pos; i--)
+		{
+			leaf->keys[i] = leaf->keys[i - 1];
+		}
+
+		leaf->keys[pos] = value;
+		leaf->count++;
+
+		return true;
+	}
+
+	BPlusInnerT<T>* inner = static_cast<BPlusInnerT<T>*>(nd);
+
+	// insert into the child the value belongs in
+	T childKey = value;
+	BPlusNodeT<T>* childSplit = nullptr;
+
+	if (!insertHelper(inner->children[childIndex(inner, value)], value, childKey, childSplit))
+	{
+		return false;
+	}
+
+	// nothing more to do if the child didn't split
+	isNullptr(childSplit, true);
+
+	// a full inner node moves its middle separator up and its upper half to a new node
+	if (inner->count == capacity)
+	{
+		BPlusInnerT<T>* newInner = new BPlusInnerT<T>();
+		int half = capacity / 2;
+
+		for (int i = half + 1; i < capacity; i++)
+		{
+			newInner->keys[i - half - 1] = inner->keys[i];
+		}
+
+		for (int i = half + 1; i <= capacity; i++)
+		{
+			newInner->children[i - half - 1] = inner->children[i];
+		}
+
+		newInner->count = capacity - half - 1;
+		inner->count = half;
+
+		splitKey = inner->keys[half];
+		splitNode = newInner;
+
+		// the child's split goes into whichever half it belongs in
+		if (!(childKey < splitKey))
+		{
+			inner = newInner;
+		}
+	}
+
+	// shift the bigger separators and their right children over and put the split in
+	int pos = childIndex(inner, childKey);
+
+	for (int i = inner->count; i > pos; i--)
+	{
+		inner->keys[i] = inner->keys[i - 1];
+		inner->children[i + 1] = inner->children[i];
+	}
+
+	inner->keys[pos] = childKey;
+	inner->children[pos + 1] = childSplit;
+	inner->count++;
+
+	return true;
+}
+
+template<class T>
+bool BPlusTree<T>::removeHelper(BPlusNodeT<T>* nd, T value)
+{
+	if (nd->isLeaf)
+	{
+		// find the value in the leaf
+		T* it = std::lower_bound(nd->keys, nd->keys + nd->count, value);
+
+		// the value is not in the tree
+		if (it == nd->keys + nd->count || !(*it == value))
+		{
+			return false;
+		}
+
+		// shift the bigger values over it
+		for (int i = (int)(it - nd->keys); i < nd->count - 1; i++)
+		{
+			nd->keys[i] = nd->keys[i + 1];
+		}
+
+		nd->count--;
+
+		return true;
+	}
+
+	BPlusInnerT<T>* inner = static_cast<BPlusInnerT<T>*>(nd);
+
+	// remove from the child the value belongs in
+	int i = childIndex(inner, value);
+
+	if (!removeHelper(inner->children[i], value))
+	{
+		return false;
+	}
+
+	// refill the child if it dropped below the minimum
+	if (inner->children[i]->count < inner->children[i]->minimum())
+	{
+		fixUnderflow(inner, i);
+	}
+
+	return true;
+}
+
+template<class T>
+void BPlusTree<T>::fixUnderflow(BPlusInnerT<T>* parent, int i)
+{
+	BPlusNodeT<T>* child = parent->children[i];
+	int minimum = child->minimum();
+	BPlusNodeT<T>* leftSibling = (i > 0) ? parent->children[i - 1] : nullptr;
+	BPlusNodeT<T>* rightSibling = (i < parent->count) ? parent->children[i + 1] : nullptr;
+
+	// borrow the largest value of the left sibling
+	if (leftSibling != nullptr && leftSibling->count > minimum)
+	{
+		for (int j = child->count; j > 0; j--)
+		{
+			child->keys[j] = child->keys[j - 1];
+		}
+
+		if (child->isLeaf)
+		{
+			// the value moves over and becomes the new separator
+			child->keys[0] = leftSibling->keys[leftSibling->count - 1];
+			parent->keys[i - 1] = child->keys[0];
+		}
+		else
+		{
+			// the separator comes down and the sibling's last separator goes up, with its child moving over
+			BPlusInnerT<T>* innerChild = static_cast<BPlusInnerT<T>*>(child);
+			BPlusInnerT<T>* innerSibling = static_cast<BPlusInnerT<T>*>(leftSibling);
+
+			for (int j = innerChild->count + 1; j > 0; j--)
+			{
+				innerChild->children[j] = innerChild->children[j - 1];
+			}
+
+			innerChild->keys[0] = parent->keys[i - 1];
+			innerChild->children[0] = innerSibling->children[innerSibling->count];
+			parent->keys[i - 1] = innerSibling->keys[innerSibling->count - 1];
+		}
+
+		child->count++;
+		leftSibling->count--;
+	}
+	else if (rightSibling != nullptr && rightSibling->count > minimum) // symmetric to the if
+	{
+		if (child->isLeaf)
+		{
+			child->keys[child->count] = rightSibling->keys[0];
+		}
+		else
+		{
+			BPlusInnerT<T>* innerChild = static_cast<BPlusInnerT<T>*>(child);
+			BPlusInnerT<T>* innerSibling = static_cast<BPlusInnerT<T>*>(rightSibling);
+
+			innerChild->keys[innerChild->count] = parent->keys[i];
+			innerChild->children[innerChild->count + 1] = innerSibling->children[0];
+			parent->keys[i] = innerSibling->keys[0];
+
+			for (int j = 0; j < innerSibling->count; j++)
+			{
+				innerSibling->children[j] = innerSibling->children[j + 1];
+			}
+		}
+
+		for (int j = 0; j < rightSibling->count - 1; j++)
+		{
+			rightSibling->keys[j] = rightSibling->keys[j + 1];
+		}
+
+		child->count++;
+		rightSibling->count--;
+
+		// a leaf's separator is the sibling's new first value
+		if (child->isLeaf)
+		{
+			parent->keys[i] = rightSibling->keys[0];
+		}
+	}
+	else if (leftSibling != nullptr)
+	{
+		// neither sibling can spare a value so two of them become one
+		mergeChildren(parent, i - 1);
+	}
+	else
+	{
+		mergeChildren(parent, i);
+	}
+}
+
+template<class T>
+void BPlusTree<T>::mergeChildren(BPlusInnerT<T>* parent, int i)
+{
+	BPlusNodeT<T>* leftNode = parent->children[i];
+	BPlusNodeT<T>* rightNode = parent->children[i + 1];
+
+	if (leftNode->isLeaf)
+	{
+		// the right leaf's values are appended and it is unlinked
+		for (int j = 0; j < rightNode->count; j++)
+		{
+			leftNode->keys[leftNode->count + j] = rightNode->keys[j];
+		}
+
+		leftNode->count += rightNode->count;
+		static_cast<BPlusLeafT<T>*>(leftNode)->next = static_cast<BPlusLeafT<T>*>(rightNode)->next;
+	}
+	else
+	{
+		// the separator between them comes down in the middle
+		BPlusInnerT<T>* innerLeft = static_cast<BPlusInnerT<T>*>(leftNode);
+		BPlusInnerT<T>* innerRight = static_cast<BPlusInnerT<T>*>(rightNode);
+
+		innerLeft->keys[innerLeft->count] = parent->keys[i];
+
+		for (int j = 0; j < innerRight->count; j++)
+		{
+			innerLeft->keys[innerLeft->count + 1 + j] = innerRight->keys[j];
+		}
+
+		for (int j = 0; j <= innerRight->count; j++)
+		{
+			innerLeft->children[innerLeft->count + 1 + j] = innerRight->children[j];
+		}
+
+		innerLeft->count += innerRight->count + 1;
+	}
+
+	deleteNode(rightNode);
+
+	// take the separator and the right child out of the parent
+	for (int j = i; j < parent->count - 1; j++)
+	{
+		parent->keys[j] = parent->keys[j + 1];
+		parent->children[j + 1] = parent->children[j + 2];
+	}
+
+	parent->count--;
+}
@@ -0,0 +1,172 @@
+#pragma once
+#include "RedBlackTree.h"
+
+// a closed interval [low, high], ordered by low and then by high
+template<class K>
+class Interval
+{
+public:
+
+	K low;
+	K high;
+
+	// init the vars, if low is bigger than high they are flipped
+	Interval(K lowValue, K highValue)
+		:low(lowValue), high(highValue)
+	{
+		if (high < low)
+		{
+			low = highValue;
+			high = lowValue;
+		}
+	};
+
+	// checks if the two intervals share at least one point
+	bool overlaps(K otherLow, K otherHigh) const
+	{
+		return !(high < otherLow) && !(otherHigh < low);
+	};
+
+	bool operator==(const Interval<K>& other) const { return low == other.low && high == other.high; };
+	bool operator!=(const Interval<K>& other) const { return !(*this == other); };
+	bool operator<(const Interval<K>& other) const { return low < other.low || (low == other.low && high < other.high); };
+	bool operator>(const Interval<K>& other) const { return other < *this; };
+	bool operator<=(const Interval<K>& other) const { return !(other < *this); };
+	bool operator>=(const Interval<K>& other) const { return !(*this < other); };
+};
+
+// interval nodes also keep the largest high endpoint in their subtree
+// the tree keeps it up to date through update() on every insert, remove and rotation
+template<class K>
+class NodeAugment<Interval<K>>
+{
+public:
+
+	// largest high endpoint in the subtree, marked intervals are still counted
+	K maxHigh;
+
+	// init the vars
+	NodeAugment(const Interval<K>& val)
+		:maxHigh(val.high)
+	{};
+
+	static const bool augmented = true;
+
+	// recompute maxHigh from the node and its children
+	static void update(NodeT<Interval<K>>* nd)
+	{
+		nd->augment.maxHigh = nd->data.high;
+
+		if (nd->left != nullptr && nd->augment.maxHigh < nd->left->augment.maxHigh)
+		{
+			nd->augment.maxHigh = nd->left->augment.maxHigh;
+		}
+
+		if (nd->right != nullptr && nd->augment.maxHigh < nd->right->augment.maxHigh)
+		{
+			nd->augment.maxHigh = nd->right->augment.maxHigh;
+		}
+	};
+
+};
+
+// red-black tree of intervals that can answer overlap queries
+// subtrees are pruned by their largest high endpoint, so every reported interval costs at most
+// one path down the tree and a query is O(min(n, k log n)) for k results, not O(log n + k)
+template<class K>
+class IntervalTree : public RedBlackTree<Interval<K>>
+{
+public:
+
+	// keep the inherited overloads that take an Interval
+	using RedBlackTree<Interval<K>>::insert;
+	using RedBlackTree<Interval<K>>::remove;
+	using RedBlackTree<Interval<K>>::search;
+
+	// inserts the interval [low, high] into the tree
+	bool insert(K low, K high);
+
+	// remove's the interval [low, high] from the tree
+	bool remove(K low, K high);
+
+	// returns every interval that contains the point, sorted
+	vector<Interval<K>> overlaps(K point) const;
+
+	// returns every interval that shares at least one point with [low, high], sorted
+	vector<Interval<K>> overlaps(K low, K high) const;
+
+private:
+
+	// --HELPERS =================================================================================================
+
+	// traverse the tree recursively, skipping subtrees that end before low or start after high
+	void overlapTraversalHelper(NodeT<Interval<K>>* nd, vector<Interval<K>>& vec, K low, K high) const;
+};
+
+template<class K>
+bool IntervalTree<K>::insert(K low, K high)
+{
+	return RedBlackTree<Interval<K>>::insert(Interval<K>(low, high));
+}
+
+template<class K>
+bool IntervalTree<K>::remove(K low, K high)
+{
+	return RedBlackTree<Interval<K>>::remove(Interval<K>(low, high));
+}
+
+template<class K>
+vector<Interval<K>> IntervalTree<K>::overlaps(K point) const
+{
+	return overlaps(point, point);
+}
+
+template<class K>
+vector<Interval<K>> IntervalTree<K>::overlaps(K low, K high) const
+{
+	// create a vector with interval types
+	vector<Interval<K>> results;
+
+	// second is bigger so we flip
+	if (high < low)
+	{
+		K swapTemp = low;
+		low = high;
+		high = swapTemp;
+	}
+
+	// call the recursive method and pass the vector as a ref
+	overlapTraversalHelper(this->root, results, low, high);
+
+	// return the vector when finished
+	return results;
+}
+
+template<class K>
+void IntervalTree<K>::overlapTraversalHelper(NodeT<Interval<K>>* nd, vector<Interval<K>>& vec, K low, K high) const
+{
+	// check if the param is null if so return
+	isNullptr(nd);
+
+	// nothing in this subtree reaches low
+	if (nd->augment.maxHigh < low)
+	{
+		return;
+	}
+
+	// the left subtree starts no later than this node
+	overlapTraversalHelper(nd->left, vec, low, high);
+
+	// this node and everything to its right starts after high
+	if (high < nd->data.low)
+	{
+		return;
+	}
+
+	if (nd->data.overlaps(low, high) && !nd->isDeleted)
+	{
+		vec.push_back(nd->data);
+	}
+
+	overlapTraversalHelper(nd->right, vec, low, high);
+}
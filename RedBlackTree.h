@@ -4,6 +4,13 @@
 #include <string>
 #include <fstream>
 #include <algorithm>
+#include <functional>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <system_error>
+#include <new>
 
 using std::cout;
 using std::endl;
@@ -28,6 +35,30 @@ using std::upper_bound;
 void statistics(string filename);
 
 
+template<class T>
+class NodeT;
+
+// extra data a node keeps about its subtree, a plain node keeps none
+// specialize it for a value type to augment its nodes (see IntervalTree.h)
+// it is the node's last member so small augmentations fit in the padding after the flags
+template<class T>
+class NodeAugment
+{
+public:
+
+	// init the vars from the node's value
+	NodeAugment(const T&)
+	{};
+
+	// the tree calls update whenever a node's children change
+	static const bool augmented = false;
+
+	// recompute the subtree data from the node and its children
+	static void update(NodeT<T>*)
+	{};
+
+};
+
 template<class T>
 class NodeT
 {
@@ -40,11 +71,102 @@ public:
 	NodeT<T>* parent;
 	bool isBlack;
 
+	// marked as deleted but still linked into the tree, see enableLazyDeletion
+	bool isDeleted;
+
+	// subtree data, empty unless NodeAugment is specialized for T
+	NodeAugment<T> augment;
+
 	// init the vars
 	NodeT(T val)
-		:data(val), left(nullptr), right(nullptr), parent(nullptr), isBlack(false)
+		:data(val), left(nullptr), right(nullptr), parent(nullptr), isBlack(false), isDeleted(false), augment(val)
 	{};
 
+	// recompute the subtree data, for a plain node it does nothing
+	void update()
+	{
+		NodeAugment<T>::update(this);
+	};
+
+};
+
+// counting bloom filter used by the tree to answer "definitely not here" without descending
+// each slot is a small counter instead of a bit so values can be removed again
+// the slots are grouped in 64 byte blocks and a value only touches the slots of one block,
+// so adding, removing or looking up a value costs a single cache miss
+template<class T>
+class CountingBloomFilter
+{
+public:
+
+	// hashes a value, T only needs a std::hash once a filter is created
+	typedef size_t (*HashFunction)(const T&);
+
+	// constructor
+	// --PARAM: expectedSize is the number of values the filter is sized for,
+	// falsePositiveRate is the target rate, anything outside of (0, 1) falls back to 0.01,
+	// hashFunction is used for every value, standardHash uses std::hash<T>
+	CountingBloomFilter(int expectedSize, double falsePositiveRate, HashFunction hashFunction);
+
+	// hashes the value with std::hash<T>
+	static size_t standardHash(const T& value);
+
+	// adds a value to the filter
+	void add(const T& value);
+
+	// removes a value from the filter, the value must have been added before
+	void remove(const T& value);
+
+	// returns false if the value is definitely not in the filter and true if it might be
+	bool mayContain(const T& value) const;
+
+	// returns the false positive rate the filter was sized for
+	double falsePositiveRate() const;
+
+	// returns the number of values the filter was sized for
+	int capacity() const;
+
+	// returns the hash function the filter was created with
+	HashFunction hashFunction() const;
+
+	// returns the bytes held by the counters
+	size_t memoryUsage() const;
+
+private:
+
+	// variables
+	// one saturating counter per slot, with room to start the first block on a cache line
+	vector<unsigned char> counters;
+
+	// number of 64 slot blocks
+	size_t blockCount;
+
+	// number of slots each value touches
+	int hashCount;
+
+	// number of values the filter was sized for
+	int expected;
+
+	// false positive rate the filter was sized for
+	double targetRate;
+
+	// hash function every value goes through
+	HashFunction hasher;
+
+	// --HELPERS =================================================================================================
+
+	// hash the value and mix it so both halves of the result can be used as independent hashes
+	uint64_t hashValue(const T& value) const;
+
+	// returns the expected false positive rate when every block holds perBlock values on average
+	// and each value sets hashes slots, averaged over the Poisson spread of values per block
+	static double blockedRate(double perBlock, int hashes);
+
+	// returns the index of the first slot of the value's block, blocks start on a cache line
+	size_t blockStart(uint64_t hash) const;
+
+	// returns the i'th slot inside the value's block
+	size_t blockSlot(uint64_t hash, int i) const;
 };
 
 template<class T>
@@ -70,12 +192,30 @@ public:
 	// inserts its template type parameter into the tree
 	bool insert(T value);
 
+	// inserts starting from a finger instead of the root and moves the finger to the new node
+	// --PARAM: finger is a node from this tree or nullptr to start from the root,
+	// any finger is invalidated by remove
+	bool insert(T value, NodeT<T>*& finger);
+
 	// remove's its template type parameter from the tree
+	// with lazy deletion on this can trigger an O(n) purge, see enableLazyDeletion
 	bool remove(T value);
 
+	// remove's every value in the range [begin, end] from the tree and returns how many were removed
+	// large ranges are dropped at once and the rest of the tree is rebuilt in linear time
+	int remove(T begin, T end);
+
 	// search if value is in the tree and return true if found otherwise false
 	bool search(T value) const;
 
+	// search starting from a finger instead of the root, only climbing as far up as the value needs,
+	// which for a value next to the finger is usually a few steps, but with only parent pointers the
+	// worst case is still O(log n), e.g. from the smallest node of the root's right subtree to the root
+	// the finger is moved to the last node visited so the next nearby search is cheap as well
+	// --PARAM: finger is a node from this tree or nullptr to start from the root,
+	// any finger is invalidated by remove
+	bool search(T value, NodeT<T>*& finger) const;
+
 	// search the tree for values in a specific range and returm a vector of T types
 	vector<T> search(T begin, T end) const;
 
@@ -88,10 +228,71 @@ public:
 	// returns a vector with all the values in the tree
 	vector<T> values() const;
 
+	// same as values() but the top of the tree is split into subtrees that are walked by all cores at once
+	// trees under 65536 values are walked on the calling thread
+	vector<T> parallelValues() const;
+
+	// calls the visitor on every value in the tree using all cores, the order is unspecified
+	// trees under 65536 values are walked on the calling thread
+	// --PARAM: visitor takes a const T&, it is called from several threads at once so it has to be thread safe
+	template<class Visitor>
+	void parallelForEach(Visitor visitor) const;
+
 	// return the tree size
 	int size() const; 
 
-private:
+	// puts a counting bloom filter in front of the tree so searches for values that are not
+	// in the tree can usually return without descending, in exchange every insert and remove
+	// also updates the filter, which costs about one more cache miss
+	// --PARAM: falsePositiveRate is the target rate in (0, 1), expectedSize is the number of values
+	// to size the filter for, if it is less than twice the tree size that is used instead so the
+	// inserts right after don't have to rebuild it
+	void enableFilter(double falsePositiveRate = 0.01, int expectedSize = 0);
+
+	// removes the filter, searches go straight to the tree again
+	void disableFilter();
+
+	// returns the false positive rate of the filter or 0 if there is no filter
+	double filterFalsePositiveRate() const;
+
+	// moves every node into one contiguous block in sorted order so in order scans walk memory
+	// front to back again, returns the bytes reclaimed, where the heap overhead per node is estimated
+	// every finger is invalidated
+	size_t compact();
+
+	// turns deferred deletion on or off, when on remove only marks the node as deleted and every
+	// search, range search and values() skip it, once the marked nodes make up more than threshold
+	// of the tree they are purged in one go, turning it off purges right away
+	// that purge rebuilds the tree inside the remove call that crossed the threshold, so to keep
+	// removes cheap pass a threshold of 0 and call purge() at a quiet time instead
+	// --PARAM: threshold is a fraction in (0, 1], or 0 to never purge on its own,
+	// anything else falls back to 0.25
+	void enableLazyDeletion(bool enabled, double threshold = 0.25);
+
+	// removes every node marked as deleted and rebuilds the tree in linear time
+	void purge();
+
+	// returns the number of nodes that are marked as deleted but not purged yet
+	int deletedCount() const;
+
+	// bounds the tree to capacity values, once it is full an insert evicts the smallest value
+	// if keepLargestValues is true and the largest otherwise, and a value that would be evicted
+	// right away is not inserted at all, the evicted node invalidates any finger on it
+	// --PARAM: capacity of 0 removes the bound, a capacity below the size evicts right away
+	void setCapacity(int capacity, bool keepLargestValues = true);
+
+	// returns the bytes used by the tree, its nodes, the arena and the filter
+	// heap nodes include an estimate of the allocator's overhead, memory owned by the values isn't counted
+	size_t memoryUsage() const;
+
+	// turns parallel copying and clearing on or off, when on the copy constructor, operator= and
+	// the destructor use all cores for trees of at least 65536 values, it is off by default since
+	// they then start their own threads, which is wasted on a tree destroyed inside a thread pool
+	// if no thread can be started, e.g. without -pthread on older toolchains, the work is done serially
+	void enableParallelCopy(bool enabled);
+
+
+protected:
 
 	// variables
 	// tree root
@@ -100,6 +301,43 @@ private:
 	// tree size
 	int currentSize;
 
+	// optional membership filter, nullptr when it's not in use
+	CountingBloomFilter<T>* filter;
+
+	// whether remove only marks nodes, the fraction of marked nodes that triggers a purge or 0 for none
+	// and the number of marked nodes, which aren't counted in currentSize
+	bool lazyDeletion;
+	double purgeThreshold;
+	int tombstones;
+
+	// smallest and largest node, including marked ones, so the ends are found without descending
+	NodeT<T>* leftmost;
+	NodeT<T>* rightmost;
+
+	// the most values the tree keeps, 0 for no bound, and which end is kept
+	int capacityLimit;
+	bool keepLargest;
+
+
+	// block the nodes were moved into by compact(), its size in nodes and the slots in it
+	// that were freed since, new nodes go into those before going to the heap
+	NodeT<T>* arena;
+	int arenaCapacity;
+	vector<NodeT<T>*> freeSlots;
+
+	// whether trees at least parallelThreshold big are copied and cleared in parallel,
+	// smaller trees are always walked on the calling thread
+	bool parallelCopy;
+	static const int parallelThreshold = 1 << 16;
+
+	// a subtree left to copy, and the node and side the copy gets attached to
+	struct CopyTask
+	{
+		NodeT<T>* source;
+		NodeT<T>* parent;
+		bool isLeft;
+	};
+
 	// --HELPERS =================================================================================================
 
 	// recursive function to copy all the values in the tree
@@ -108,6 +346,55 @@ private:
 	// clear the whole tree
 	void clearTreeHelper(NodeT<T>* nd) const;
 
+	// create a node in a free arena slot or on the heap
+	NodeT<T>* allocateNode(T value);
+
+	// delete a node, an arena slot is kept for reuse
+	void freeNode(NodeT<T>* nd);
+
+	// delete a node without keeping its arena slot, safe to call from several threads at once
+	void destroyNode(NodeT<T>* nd) const;
+
+	// checks if the node lives in the arena
+	bool inArena(NodeT<T>* nd) const;
+
+	// give back the arena, every node in it must be destroyed already
+	void releaseArena();
+
+	// bytes held by the nodes, the arena and its free slots
+	size_t nodeBytes() const;
+
+	// estimated bytes a node takes on the heap, a typical malloc adds a word of
+	// bookkeeping to every allocation and rounds it up to 16 bytes
+	static size_t heapNodeBytes();
+
+	// recursive function to move the subtree in order into the block starting at slot next
+	NodeT<T>* relocateHelper(NodeT<T>* nd, NodeT<T>* block, int& next);
+
+	// copy the top of the tree and hand the subtrees below it to all cores
+	NodeT<T>* parallelCopyHelper(NodeT<T>* copy);
+
+	// recursive function to copy the top levels of the tree, the subtrees below depth are left as tasks
+	NodeT<T>* copyTopHelper(NodeT<T>* copy, int depth, vector<CopyTask>& tasks);
+
+	// clear the whole tree using all cores
+	void parallelClearHelper(NodeT<T>* nd) const;
+
+	// split the tree in order into single nodes above depth and whole subtrees at depth
+	// the bool is true for a whole subtree
+	void partitionHelper(NodeT<T>* nd, int depth, vector<std::pair<NodeT<T>*, bool>>& pieces) const;
+
+	// recursive function to call the visitor on every value in the subtree
+	template<class Visitor>
+	void forEachHelper(NodeT<T>* nd, Visitor& visitor) const;
+
+	// number of levels to split off so every core gets several subtrees to balance the load
+	static int partitionDepth();
+
+	// run task(0) .. task(taskCount - 1) on all cores, idle threads grab the next task that is left
+	// if threads can't be started the calling thread runs whatever is left
+	static void runParallel(int taskCount, const std::function<void(int)>& task);
+
 	// rotate RBT
 	void rotateRight(NodeT<T>* nd);
 	void rotateLeft(NodeT<T>* nd);
@@ -116,13 +403,57 @@ private:
 	// --PARAM: it takes in the child node (nd), and nd's parent node
 	void fixRemovalRBT(NodeT<T>* ndChild, NodeT<T>* ndParent);
 
-	// BST insert
-	// --PARAM: takes in the current node, which happens to be the root, and a newNode created in dynamic memory
-	NodeT<T>* BinaryTreeInsert(NodeT<T>* ndCurrent, NodeT<T>* newNode);
+	// fix RBT after insert
+	// --PARAM: it takes in the newly attached RED node
+	void fixInsertRBT(NodeT<T>* newNode);
+
+	// update the subtree data of the node and every ancestor, only needed for augmented nodes
+	void updatePath(NodeT<T>* nd);
+
+	// recursive function to update the subtree data of the top levels once the subtrees below are in place
+	void updateTopHelper(NodeT<T>* nd, int depth);
 
 	// find value and return the node
 	NodeT<T>* find(T value) const;
 
+	// splice the node out of the tree, rebalance and delete it
+	void unlinkNode(NodeT<T>* removeNode);
+
+	// return the first node whose value is not less than the value
+	NodeT<T>* lowerBound(T value) const;
+
+	// return the next node in order or nullptr if it is the last one
+	NodeT<T>* successor(NodeT<T>* nd) const;
+
+	// return the previous node in order or nullptr if it is the first one
+	NodeT<T>* previous(NodeT<T>* nd) const;
+
+	// find leftmost and rightmost by descending, after the tree was copied or moved
+	void updateEnds();
+
+	// return the node a bounded tree evicts next, the smallest or largest one that isn't marked as deleted
+	NodeT<T>* evictionCandidate() const;
+
+	// evict values until the tree is back within its capacity
+	void evictOverflow();
+
+	// traverse the entire tree recursively, delete the nodes in the range and collect the rest in order
+	void rangeRemovalHelper(NodeT<T>* nd, vector<NodeT<T>*>& keep, T begin, T end);
+
+	// traverse the entire tree recursively, delete the nodes marked as deleted and collect the rest in order
+	void purgeTraversalHelper(NodeT<T>* nd, vector<NodeT<T>*>& keep);
+
+	// link the sorted nodes into a balanced RBT and return the root
+	NodeT<T>* buildBalanced(vector<NodeT<T>*>& nodes);
+
+	// recursively link nodes[first, last) into a subtree, nodes on the redDepth level are RED
+	NodeT<T>* buildBalancedHelper(vector<NodeT<T>*>& nodes, int first, int last, int depth, int redDepth);
+
+	// climb from the finger until the value is inside the subtree, then descend as usual
+	// returns the node holding the value, or the node it would be attached to
+	// --PARAM: finger is where to start, nullptr starts from the root
+	NodeT<T>* fingerDescend(NodeT<T>* finger, T value) const;
+
 	// predecessor recurive helper
 	NodeT<T>* predecessor(NodeT<T>* nd) const;
 
@@ -131,6 +462,12 @@ private:
 
 	// traverse the tree recursively in the given range and update's the vector ref from the search vector method
 	void searchTraversalHelper(NodeT<T>* nd, vector<T>& vec, T begin, T end) const;
+
+	// rebuild the filter for the given size and add every value in the tree to it
+	void rebuildFilter(int expectedSize);
+
+	// traverse the entire tree recursively and add the values to the filter
+	void filterTraversalHelper(NodeT<T>* nd);
 	
 };
 
@@ -145,6 +482,27 @@ RedBlackTree<T>::RedBlackTree()
 	// init the root and set the size
 	root = nullptr;
 	currentSize = 0;
+
+	// no filter until it's asked for
+	filter = nullptr;
+
+	// copy and clear on the calling thread until it's asked not to
+	parallelCopy = false;
+
+	// nodes live on the heap until compact() is called
+	arena = nullptr;
+	arenaCapacity = 0;
+
+	// remove deletes right away until it's asked not to
+	lazyDeletion = false;
+	purgeThreshold = 0.25;
+	tombstones = 0;
+
+	// no nodes and no bound yet
+	leftmost = nullptr;
+	rightmost = nullptr;
+	capacityLimit = 0;
+	keepLargest = true;
 }
 
 template<class T>
@@ -153,8 +511,43 @@ RedBlackTree<T>::RedBlackTree(const RedBlackTree<T>& copyRBT)
 	// copy the size from the param
 	currentSize = copyRBT.currentSize;
 
+	// the marked nodes are copied along with the rest
+	lazyDeletion = copyRBT.lazyDeletion;
+	purgeThreshold = copyRBT.purgeThreshold;
+	tombstones = copyRBT.tombstones;
+
+	// copy the filter as is, it already holds the same values
+	filter = nullptr;
+
+	if (copyRBT.filter != nullptr)
+	{
+		filter = new CountingBloomFilter<T>(*copyRBT.filter);
+	}
+
+	// the same parallel setting
+	parallelCopy = copyRBT.parallelCopy;
+
+	// the copy's nodes live on the heap
+	arena = nullptr;
+	arenaCapacity = 0;
+
+	// the same bound
+	capacityLimit = copyRBT.capacityLimit;
+	keepLargest = copyRBT.keepLargest;
+
 	// call the recurisve method and assign it to the root
-	root = copyHelper(copyRBT.root);
+	// big trees are copied by all cores at once if it's turned on
+	if (parallelCopy && currentSize >= parallelThreshold)
+	{
+		root = parallelCopyHelper(copyRBT.root);
+	}
+	else
+	{
+		root = copyHelper(copyRBT.root);
+	}
+
+	// find the ends of the copy
+	updateEnds();
 }
 
 template<class T>
@@ -163,14 +556,56 @@ RedBlackTree<T>& RedBlackTree<T>::operator=(const RedBlackTree<T>& copyRBT)
 	// check if the param is self
 	if (this != &copyRBT)
 	{
-		// clear the tree
-		clearTreeHelper(root);
+		// clear the tree, big trees are cleared by all cores at once if it's turned on
+		if (parallelCopy && currentSize >= parallelThreshold)
+		{
+			parallelClearHelper(root);
+		}
+		else
+		{
+			clearTreeHelper(root);
+		}
+
+		// the copy's nodes live on the heap
+		releaseArena();
 		
 		// copy the size from the param
 		currentSize = copyRBT.currentSize;
 
+		// the marked nodes are copied along with the rest
+		lazyDeletion = copyRBT.lazyDeletion;
+		purgeThreshold = copyRBT.purgeThreshold;
+		tombstones = copyRBT.tombstones;
+
+		// copy the filter as is, it already holds the same values
+		delete filter;
+		filter = nullptr;
+
+		if (copyRBT.filter != nullptr)
+		{
+			filter = new CountingBloomFilter<T>(*copyRBT.filter);
+		}
+
+		// the same parallel setting
+		parallelCopy = copyRBT.parallelCopy;
+
+		// the same bound
+		capacityLimit = copyRBT.capacityLimit;
+		keepLargest = copyRBT.keepLargest;
+
 		// call the recurisve method and assign it to the root
-		root = copyHelper(copyRBT.root);
+		// big trees are copied by all cores at once if it's turned on
+		if (parallelCopy && currentSize >= parallelThreshold)
+		{
+			root = parallelCopyHelper(copyRBT.root);
+		}
+		else
+		{
+			root = copyHelper(copyRBT.root);
+		}
+
+		// find the ends of the copy
+		updateEnds();
 	}
 
 	return *this;
@@ -180,7 +615,21 @@ template<class T>
 RedBlackTree<T>::~RedBlackTree()
 {
 	// call the method to clear the tree recursively
-	clearTreeHelper(root);
+	// big trees are cleared by all cores at once if it's turned on
+	if (parallelCopy && currentSize >= parallelThreshold)
+	{
+		parallelClearHelper(root);
+	}
+	else
+	{
+		clearTreeHelper(root);
+	}
+
+	// give back the compacted block if there is one
+	releaseArena();
+
+	// and the filter
+	delete filter;
 
 	// set size to 0
 	currentSize = 0;
@@ -189,99 +638,118 @@ RedBlackTree<T>::~RedBlackTree()
 template<class T>
 bool RedBlackTree<T>::insert(T value)
 {
-	// returns true if the insertParam does not exist in the tree
-	if (!search(value))
-	{
-		// create a new node with the value given
-		NodeT<T>* newNode = new NodeT<T>(value);
+	// a null finger starts from the root
+	NodeT<T>* fromRoot = nullptr;
+	return insert(value, fromRoot);
+}
 
-		// increase the size
-		currentSize++;
+template<class T>
+bool RedBlackTree<T>::insert(T value, NodeT<T>*& finger)
+{
+	// find the value, or the node it would hang off of, starting from the finger
+	NodeT<T>* parentNode = fingerDescend(finger, value);
 
-		// call the BST insert and assign it to the root
-		root = BinaryTreeInsert(root, newNode);
+	// a node that is only marked as deleted comes back instead of a new one
+	bool unmark = false;
 
-		// set the newNode to RED
-		newNode->isBlack = false;
+	// if the value is in the tree return false. This is to prevent duplication
+	if (parentNode != nullptr && value == parentNode->data)
+	{
+		finger = parentNode;
 
-		// if the newNode is not the root and it's parent colour is RED
-		// this will iterate until the root or a black parent is reached
-		while (newNode != root && newNode->parent->isBlack == false)
+		if (!parentNode->isDeleted)
 		{
-			// Set the Grandparent of the NewNode
-			NodeT<T>* grandParent = newNode->parent->parent;
+			return false;
+		}
 
-			// checks if the newNode parent is a left child
-			if (newNode->parent == grandParent->left)
-			{
-				// "uncle" of newNode
-				NodeT<T>* uncle = grandParent->right;
+		unmark = true;
+	}
 
-				if (uncle != nullptr && uncle->isBlack == false)
-				{
-					/* 
-					The uncle and newNodes�s parent are both red so they can be
-					made black, and newNodes�s grandparent can be made
-					red, then make the newNode the grandparentand repeat
-					*/
-					newNode->parent->isBlack = true;
-					uncle->isBlack = true;
-					grandParent->isBlack = false;
-					newNode = grandParent;
-				}
-				else
-				{
-					/*
-					The newNodes�s grandparent must be black,
-					arrange newNode and parent in a line,
-					rotate newNode�s grandparent to
-					balance the tree, and fix the
-					colours
-					*/
-					if (newNode == newNode->parent->right)
-					{
-						newNode = newNode->parent;
-						rotateLeft(newNode);
-					}
-					newNode->parent->isBlack = true;
-					grandParent->isBlack = false;
-					rotateRight(grandParent);
-				}
-			}
-			else // symmetric to the if
-			{
-				NodeT<T>* uncle = grandParent->left;
+	// a full bounded tree only takes a value that beats the one it would evict
+	if (capacityLimit > 0 && currentSize >= capacityLimit)
+	{
+		NodeT<T>* candidate = evictionCandidate();
 
-				if (uncle != nullptr && uncle->isBlack == false)
-				{
-					newNode->parent->isBlack = true;
-					uncle->isBlack = true;
-					grandParent->isBlack = false;
-					newNode = grandParent;
-				}
-				else
-				{
-					if (newNode == newNode->parent->left)
-					{
-						newNode = newNode->parent;
-						rotateRight(newNode);
-					}
-					newNode->parent->isBlack = true;
-					grandParent->isBlack = false;
-					rotateLeft(grandParent);
-				}
-			}
+		if (candidate != nullptr && (keepLargest ? value < candidate->data : candidate->data < value))
+		{
+			return false;
+		}
+	}
+
+	// increase the size
+	currentSize++;
+
+	// keep the filter in sync, once the tree outgrows it the false positive rate
+	// climbs so it is rebuilt at double the size first
+	if (filter != nullptr)
+	{
+		if (currentSize > filter->capacity())
+		{
+			rebuildFilter(currentSize * 2);
 		}
 
-		// if the root set it to black
-		root->isBlack = true;
+		filter->add(value);
+	}
+
+	// unmark the node, it's already in the right place
+	if (unmark)
+	{
+		parentNode->isDeleted = false;
+		tombstones--;
+
+		// make room if the tree is bounded
+		evictOverflow();
 
-		// return true
 		return true;
 	}
 
-	// otherwise if the value is in the tree return false. This is to prevent duplication
-	return false;
+	// create a new node with the value given
+	NodeT<T>* newNode = allocateNode(value);
+
+	// attach the newNode as a RED leaf where the search ended
+	newNode->parent = parentNode;
+
+	if (parentNode == nullptr)
+	{
+		root = newNode;
+	}
+	else if (value < parentNode->data)
+	{
+		parentNode->left = newNode;
+	}
+	else
+	{
+		parentNode->right = newNode;
+	}
+
+	// the ancestors' subtree data now has to cover the newNode
+	if (NodeAugment<T>::augmented)
+	{
+		updatePath(parentNode);
+	}
+
+	// the newNode might be a new end of the tree
+	if (leftmost == nullptr || value < leftmost->data)
+	{
+		leftmost = newNode;
+	}
+
+	if (rightmost == nullptr || rightmost->data < value)
+	{
+		rightmost = newNode;
+	}
+
+	// fix the colours and rotate back into a RBT
+	fixInsertRBT(newNode);
+
+	// make room if the tree is bounded, the newNode beat the evicted value so it stays
+	evictOverflow();
+
+	// the next nearby value starts from here
+	finger = newNode;
+
+	// return true
+	return true;
 }
 
 template<class T>
@@ -290,100 +758,127 @@ bool RedBlackTree<T>::remove(T value)
 	// find the value you want to remove
 	NodeT<T>* removeNode = find(value);
 
-	// assign other pointers to nullptr for predecessor and the predecessor's child
-	NodeT<T>* temp = nullptr;
-	NodeT<T>* tempChild = nullptr;
+	// otherwise the value is not in the tree
+	isNullptr(removeNode, false);
 
-	// returns true if the insertParam does exist in the tree
-	if (search(value))
+	// or it was removed already and is only waiting to be purged
+	if (removeNode->isDeleted)
 	{
-		// checks if the removeNode has no childern
-		if (removeNode->left == nullptr || removeNode->right == nullptr)
-		{
-			temp = removeNode;
-		}
-		else 
-		{ 
-			// otherwise it has two children so we grab the predecessor
-			temp = predecessor(removeNode);
-		}
+		return false;
+	}
 
-		// identify if temp�s only child is right or left
-		if (temp->left != nullptr) 
-		{ 
-			tempChild = temp->left; 
-		}
-		else 
-		{ 
-			tempChild = temp->right; 
-		}
+	if (lazyDeletion)
+	{
+		// only mark the node, the tree stays as it is
+		removeNode->isDeleted = true;
+		tombstones++;
+		currentSize--;
 
-		// check if temp child is not null
-		if (tempChild != nullptr)
+		// keep the filter in sync
+		if (filter != nullptr)
 		{
-			// detach the tempChild from temp
-			tempChild->parent = temp->parent;
+			filter->remove(value);
 		}
 
-		// check if temp is the root
-		if (temp->parent == nullptr) 
-		{ 
-			// make the tempChild the root
-			root = tempChild;
-		}
-		else
+		// purge once there are too many marked nodes, unless it's left to the caller
+		if (purgeThreshold > 0.0 && tombstones > purgeThreshold * (currentSize + tombstones))
 		{
-			// attach tempChild to temp's parent
-			if (temp == temp->parent->left)//is left
-			{ 
-				temp->parent->left = tempChild; 
-			}
-			else // is right
-			{ 
-				temp->parent->right = tempChild;
-			}
+			purge();
 		}
+	}
+	else
+	{
+		// splice it out and rebalance
+		unlinkNode(removeNode);
+	}
 
-		// if temp and removeNode aren't the same
-		if (temp != removeNode)
+	// return true
+	return true;
+}
+
+template<class T>
+int RedBlackTree<T>::remove(T begin, T end)
+{
+	// second is bigger so we flip
+	if (end < begin)
+	{
+		T swapTemp = begin;
+		begin = end;
+		end = swapTemp;
+	}
+
+	// the first node in the range
+	NodeT<T>* first = lowerBound(begin);
+
+	// count how many nodes the range covers, and how many of them aren't marked as deleted
+	int count = 0;
+	int liveCount = 0;
+
+	for (NodeT<T>* nd = first; nd != nullptr && !(end < nd->data); nd = successor(nd))
+	{
+		count++;
+
+		if (!nd->isDeleted)
 		{
-			// replace removeNode data with the temp data
-			removeNode->data = temp->data;
+			liveCount++;
 		}
+	}
 
-		// checks if the temp is black, if so call the fix for removal method
-		if (temp->isBlack == true) 
-		{ 
-			fixRemovalRBT(tempChild, temp->parent); 
-		}
+	// nothing to remove
+	if (count == 0)
+	{
+		return 0;
+	}
 
-		// delete the temp
-		delete temp;
+	// once the range is a good chunk of the tree it is cheaper to throw the range away
+	// and rebuild what is left in linear time than to rebalance for every node
+	// the marked nodes outside the range are purged on the way
+	if (count * 4 >= currentSize + tombstones)
+	{
+		vector<NodeT<T>*> keep;
+		keep.reserve(currentSize - liveCount);
+		rangeRemovalHelper(root, keep, begin, end);
 
-		// decrease the tree size
-		currentSize--;
+		currentSize = (int)keep.size();
+		tombstones = 0;
+		root = buildBalanced(keep);
 
-		// return true
-		return true;
+		return liveCount;
 	}
 
-	// otherwise the value is not in the tree
-	return false;
+	// otherwise splice the nodes out one by one in order, without searching for them again
+	NodeT<T>* nd = first;
+
+	for (int i = 0; i < count; i++)
+	{
+		// unlinking nd only ever deletes nd or its predecessor so the successor stays put
+		NodeT<T>* next = successor(nd);
+		unlinkNode(nd);
+		nd = next;
+	}
+
+	return liveCount;
 }
 
 template<class T>
 bool RedBlackTree<T>::search(T value) const
 {
+	// the filter never says no to a value that is in the tree
+	if (filter != nullptr && !filter->mayContain(value))
+	{
+		return false;
+	}
+
 	// a traverse pointer
 	NodeT<T>* ptr = root;
 
 	// as long as if the traverse pointer is not nullptr
 	while (ptr != nullptr) 
 	{
-		// if the value is found return true
+		// if the value is found return true, unless it is marked as deleted
 		if (value == ptr->data) 
 		{ 
-			return true; 
+			return !ptr->isDeleted; 
 		}
 		else if (value < ptr->data) // checks if value is less than
 		{
@@ -399,6 +894,21 @@ bool RedBlackTree<T>::search(T value) const
 	return false;
 }
 
+template<class T>
+bool RedBlackTree<T>::search(T value, NodeT<T>*& finger) const
+{
+	// the filter never says no to a value that is in the tree
+	if (filter != nullptr && !filter->mayContain(value))
+	{
+		return false;
+	}
+
+	// move the finger to wherever the search ended, even if the value isn't there
+	finger = fingerDescend(finger, value);
+
+	return finger != nullptr && value == finger->data && !finger->isDeleted;
+}
+
 template<class T>
 vector<T> RedBlackTree<T>::search(T begin, T end) const
 {
@@ -479,6 +989,81 @@ vector<T> RedBlackTree<T>::values() const
 	return res;
 }
 
+template<class T>
+vector<T> RedBlackTree<T>::parallelValues() const
+{
+	// create a vector with T type's
+	vector<T> res;
+
+	// check if the root is nullptr
+	// if so return an empty vector
+	isNullptr(root, res);
+
+	// starting threads costs more than walking a small tree
+	if (currentSize < parallelThreshold)
+	{
+		valueTraversalHelper(root, res);
+		return res;
+	}
+
+	// split the tree in order, every piece is collected into its own vector
+	vector<std::pair<NodeT<T>*, bool>> pieces;
+	partitionHelper(root, partitionDepth(), pieces);
+
+	vector<vector<T>> parts(pieces.size());
+
+	runParallel((int)pieces.size(), [&](int i)
+	{
+		if (pieces[i].second)
+		{
+			valueTraversalHelper(pieces[i].first, parts[i]);
+		}
+		else if (!pieces[i].first->isDeleted)
+		{
+			parts[i].push_back(pieces[i].first->data);
+		}
+	});
+
+	// the pieces are in order so they only have to be stitched together
+	res.reserve(currentSize);
+
+	for (vector<T>& part : parts)
+	{
+		res.insert(res.end(), part.begin(), part.end());
+	}
+
+	// return the vector
+	return res;
+}
+
+template<class T>
+template<class Visitor>
+void RedBlackTree<T>::parallelForEach(Visitor visitor) const
+{
+	// starting threads costs more than walking a small tree
+	if (currentSize < parallelThreshold)
+	{
+		forEachHelper(root, visitor);
+		return;
+	}
+
+	// split the tree and hand the pieces to all cores
+	vector<std::pair<NodeT<T>*, bool>> pieces;
+	partitionHelper(root, partitionDepth(), pieces);
+
+	runParallel((int)pieces.size(), [&](int i)
+	{
+		if (pieces[i].second)
+		{
+			forEachHelper(pieces[i].first, visitor);
+		}
+		else if (!pieces[i].first->isDeleted)
+		{
+			visitor((const T&)pieces[i].first->data);
+		}
+	});
+}
+
 template<class T>
 int RedBlackTree<T>::size() const
 {
@@ -486,6 +1071,162 @@ int RedBlackTree<T>::size() const
 	return currentSize;
 }
 
+template<class T>
+void RedBlackTree<T>::enableFilter(double falsePositiveRate, int expectedSize)
+{
+	// the filter has to hold what is already in the tree with room to grow, otherwise
+	// the next insert would outgrow it and rebuild it from the whole tree
+	if (expectedSize < 2 * currentSize)
+	{
+		expectedSize = 2 * currentSize;
+	}
+
+	// create the filter with the new rate and fill it with the tree's values
+	// the hash function is only looked up here so T doesn't need a std::hash unless a filter is used
+	delete filter;
+	filter = new CountingBloomFilter<T>(expectedSize, falsePositiveRate, CountingBloomFilter<T>::standardHash);
+	filterTraversalHelper(root);
+}
+
+template<class T>
+void RedBlackTree<T>::disableFilter()
+{
+	// give back the counters
+	delete filter;
+	filter = nullptr;
+}
+
+template<class T>
+size_t RedBlackTree<T>::compact()
+{
+	size_t before = nodeBytes();
+
+	// the marked nodes don't need to move
+	if (tombstones > 0)
+	{
+		purge();
+	}
+
+	// one block for every node, filled in sorted order
+	NodeT<T>* block = nullptr;
+
+	if (currentSize > 0)
+	{
+		// keep the nodes aligned for an over-aligned T, before C++17 new doesn't do that for single nodes either
+#ifdef __cpp_aligned_new
+		block = static_cast<NodeT<T>*>(::operator new(currentSize * sizeof(NodeT<T>), std::align_val_t(alignof(NodeT<T>))));
+#else
+		block = static_cast<NodeT<T>*>(::operator new(currentSize * sizeof(NodeT<T>)));
+#endif
+
+		int next = 0;
+		root = relocateHelper(root, block, next);
+		root->parent = nullptr;
+	}
+
+	// the ends moved along with everything else
+	updateEnds();
+
+	// every node has moved out of the old arena so it can go
+	releaseArena();
+	arena = block;
+	arenaCapacity = currentSize;
+
+	return before - nodeBytes();
+}
+
+template<class T>
+void RedBlackTree<T>::enableLazyDeletion(bool enabled, double threshold)
+{
+	// fall back to a quarter if the threshold makes no sense, 0 turns the purge off
+	if (!(threshold >= 0.0 && threshold <= 1.0))
+	{
+		threshold = 0.25;
+	}
+
+	lazyDeletion = enabled;
+	purgeThreshold = threshold;
+
+	// nothing is marked once it's off
+	if (!enabled)
+	{
+		purge();
+	}
+}
+
+template<class T>
+void RedBlackTree<T>::purge()
+{
+	// nothing to purge
+	if (tombstones == 0)
+	{
+		return;
+	}
+
+	// drop the marked nodes and rebuild from the rest
+	vector<NodeT<T>*> keep;
+	keep.reserve(currentSize);
+	purgeTraversalHelper(root, keep);
+
+	tombstones = 0;
+	root = buildBalanced(keep);
+}
+
+template<class T>
+int RedBlackTree<T>::deletedCount() const
+{
+	return tombstones;
+}
+
+template<class T>
+void RedBlackTree<T>::setCapacity(int capacity, bool keepLargestValues)
+{
+	// a negative capacity makes no sense so it means no bound as well
+	if (capacity < 0)
+	{
+		capacity = 0;
+	}
+
+	capacityLimit = capacity;
+	keepLargest = keepLargestValues;
+
+	// the tree might already be too big
+	evictOverflow();
+}
+
+template<class T>
+size_t RedBlackTree<T>::memoryUsage() const
+{
+	// the tree itself and the nodes
+	size_t bytes = sizeof(*this) + nodeBytes();
+
+	// and the filter if there is one
+	if (filter != nullptr)
+	{
+		bytes += sizeof(*filter) + filter->memoryUsage();
+	}
+
+	return bytes;
+}
+
+template<class T>
+void RedBlackTree<T>::enableParallelCopy(bool enabled)
+{
+	parallelCopy = enabled;
+}
+
+template<class T>
+double RedBlackTree<T>::filterFalsePositiveRate() const
+{
+	// no filter means no false positives
+	if (filter == nullptr)
+	{
+		return 0.0;
+	}
+
+	return filter->falsePositiveRate();
+}
+
 // --Helpers =======================================================================================
 
 template<class T>
@@ -502,8 +1243,9 @@ NodeT<T>* RedBlackTree<T>::copyHelper(NodeT<T>* copy)
 	newNode->left = copyHelper(copy->left);
 	newNode->right = copyHelper(copy->right);
 
-	// copy the colour
+	// copy the colour and the mark
 	newNode->isBlack = copy->isBlack;
+	newNode->isDeleted = copy->isDeleted;
 
 	// connect parents
 	if (copy->left != nullptr) 
@@ -516,6 +1258,8 @@ NodeT<T>* RedBlackTree<T>::copyHelper(NodeT<T>* copy)
 		newNode->right->parent = newNode;
 	}
 
+	newNode->update();
+
 	// return the newNode
 	return newNode;
 }
@@ -531,63 +1275,768 @@ void RedBlackTree<T>::clearTreeHelper(NodeT<T>* nd) const
 	clearTreeHelper(nd->right);
 
 	// and delete each node
-	delete nd;
+	destroyNode(nd);
 }
 
-template <class T>
-NodeT<T>* RedBlackTree<T>::find(T value) const
+template<class T>
+NodeT<T>* RedBlackTree<T>::allocateNode(T value)
 {
-	// create a traverse pointer
-	NodeT<T>* ptr = root;
+	// reuse a free arena slot if there is one
+	if (!freeSlots.empty())
+	{
+		NodeT<T>* slot = freeSlots.back();
+		freeSlots.pop_back();
+		return new (slot) NodeT<T>(value);
+	}
 
-	// as long as the pointer is not nullptr
-	while (ptr != nullptr) 
+	return new NodeT<T>(value);
+}
+
+template<class T>
+void RedBlackTree<T>::freeNode(NodeT<T>* nd)
+{
+	// arena slots are kept for the next insert
+	if (inArena(nd))
 	{
-		// if the value is found return the pointer
-		if (value == ptr->data) 
-		{ 
-			return ptr; 
+		nd->~NodeT<T>();
+		freeSlots.push_back(nd);
+	}
+	else
+	{
+		delete nd;
+	}
+}
+
+template<class T>
+void RedBlackTree<T>::destroyNode(NodeT<T>* nd) const
+{
+	// arena slots go back with the whole arena
+	if (inArena(nd))
+	{
+		nd->~NodeT<T>();
+	}
+	else
+	{
+		delete nd;
+	}
+}
+
+template<class T>
+bool RedBlackTree<T>::inArena(NodeT<T>* nd) const
+{
+	// std::less gives a total order even for pointers into different blocks
+	std::less<const NodeT<T>*> before;
+	return arena != nullptr && !before(nd, arena) && before(nd, arena + arenaCapacity);
+}
+
+template<class T>
+void RedBlackTree<T>::releaseArena()
+{
+	// the block was allocated with the node's alignment
+#ifdef __cpp_aligned_new
+	::operator delete(arena, std::align_val_t(alignof(NodeT<T>)));
+#else
+	::operator delete(arena);
+#endif
+	arena = nullptr;
+	arenaCapacity = 0;
+	vector<NodeT<T>*>().swap(freeSlots);
+}
+
+template<class T>
+size_t RedBlackTree<T>::nodeBytes() const
+{
+	// nodes that aren't in the arena are on the heap
+	int arenaNodes = arenaCapacity - (int)freeSlots.size();
+	int heapNodes = currentSize + tombstones - arenaNodes;
+
+	return heapNodes * heapNodeBytes() + arenaCapacity * sizeof(NodeT<T>) + freeSlots.capacity() * sizeof(NodeT<T>*);
+}
+
+template<class T>
+size_t RedBlackTree<T>::heapNodeBytes()
+{
+	return (sizeof(NodeT<T>) + sizeof(size_t) + 15) / 16 * 16;
+}
+
+template<class T>
+NodeT<T>* RedBlackTree<T>::relocateHelper(NodeT<T>* nd, NodeT<T>* block, int& next)
+{
+	// check if the param is a nullptr
+	// if so return the param
+	isNullptr(nd, nd);
+
+	// the left subtree comes first in order
+	NodeT<T>* leftChild = relocateHelper(nd->left, block, next);
+
+	// then this node takes the next slot
+	NodeT<T>* newNode = new (&block[next++]) NodeT<T>(nd->data);
+	newNode->isBlack = nd->isBlack;
+	newNode->left = leftChild;
+
+	// then the right subtree
+	newNode->right = relocateHelper(nd->right, block, next);
+
+	// connect parents
+	if (newNode->left != nullptr)
+	{
+		newNode->left->parent = newNode;
+	}
+
+	if (newNode->right != nullptr)
+	{
+		newNode->right->parent = newNode;
+	}
+
+	newNode->update();
+
+	// the old node has moved out
+	destroyNode(nd);
+
+	return newNode;
+}
+
+template<class T>
+NodeT<T>* RedBlackTree<T>::parallelCopyHelper(NodeT<T>* copy)
+{
+	// copy the top levels and collect the subtrees hanging below them
+	vector<CopyTask> tasks;
+	int depth = partitionDepth();
+	NodeT<T>* newRoot = copyTopHelper(copy, depth, tasks);
+
+	// every subtree goes onto its own side of its own parent so the tasks never touch the same pointer
+	runParallel((int)tasks.size(), [&](int i)
+	{
+		NodeT<T>* newNode = copyHelper(tasks[i].source);
+		newNode->parent = tasks[i].parent;
+
+		if (tasks[i].isLeft)
+		{
+			tasks[i].parent->left = newNode;
 		}
-		else if (value < ptr->data)// check if the value is less than
-		{ 
-			ptr = ptr->left; 
+		else
+		{
+			tasks[i].parent->right = newNode;
 		}
-		else // greater than
-		{ 
-			ptr = ptr->right; 
+	});
+
+	// the top levels could only be updated once the subtrees below them were copied
+	updateTopHelper(newRoot, depth);
+
+	return newRoot;
+}
+
+template<class T>
+NodeT<T>* RedBlackTree<T>::copyTopHelper(NodeT<T>* copy, int depth, vector<CopyTask>& tasks)
+{
+	// check if the param is a nullptr
+	// if so return the param
+	isNullptr(copy, copy);
+
+	// create a newNode and copy the colour and the mark
+	NodeT<T>* newNode = new NodeT<T>(copy->data);
+	newNode->isBlack = copy->isBlack;
+	newNode->isDeleted = copy->isDeleted;
+
+	// at the bottom of the top levels the children are left as tasks
+	if (depth == 0)
+	{
+		if (copy->left != nullptr)
+		{
+			tasks.push_back({ copy->left, newNode, true });
+		}
+
+		if (copy->right != nullptr)
+		{
+			tasks.push_back({ copy->right, newNode, false });
+		}
+
+		return newNode;
+	}
+
+	// go through the top levels assigning the left and right to the NewNode
+	newNode->left = copyTopHelper(copy->left, depth - 1, tasks);
+	newNode->right = copyTopHelper(copy->right, depth - 1, tasks);
+
+	// connect parents
+	if (newNode->left != nullptr)
+	{
+		newNode->left->parent = newNode;
+	}
+
+	if (newNode->right != nullptr)
+	{
+		newNode->right->parent = newNode;
+	}
+
+	return newNode;
+}
+
+template<class T>
+void RedBlackTree<T>::parallelClearHelper(NodeT<T>* nd) const
+{
+	// split the tree up before anything is deleted
+	vector<std::pair<NodeT<T>*, bool>> pieces;
+	partitionHelper(nd, partitionDepth(), pieces);
+
+	// each piece is deleted by whichever thread grabs it
+	runParallel((int)pieces.size(), [&](int i)
+	{
+		if (pieces[i].second)
+		{
+			clearTreeHelper(pieces[i].first);
 		}
+		else
+		{
+			destroyNode(pieces[i].first);
+		}
+	});
+}
+
+template<class T>
+void RedBlackTree<T>::partitionHelper(NodeT<T>* nd, int depth, vector<std::pair<NodeT<T>*, bool>>& pieces) const
+{
+	// check if the param is null if so return
+	isNullptr(nd);
+
+	// the whole subtree is one piece
+	if (depth == 0)
+	{
+		pieces.push_back(std::make_pair(nd, true));
+		return;
+	}
+
+	// otherwise split in order around the node
+	partitionHelper(nd->left, depth - 1, pieces);
+	pieces.push_back(std::make_pair(nd, false));
+	partitionHelper(nd->right, depth - 1, pieces);
+}
+
+template<class T>
+template<class Visitor>
+void RedBlackTree<T>::forEachHelper(NodeT<T>* nd, Visitor& visitor) const
+{
+	// check if the param is null if so return
+	isNullptr(nd);
+
+	// recurse the tree and visit every value
+	forEachHelper(nd->left, visitor);
+
+	if (!nd->isDeleted)
+	{
+		visitor((const T&)nd->data);
+	}
+
+	forEachHelper(nd->right, visitor);
+}
+
+template<class T>
+int RedBlackTree<T>::partitionDepth()
+{
+	// aim for about 8 subtrees per core
+	int threadCount = (int)std::thread::hardware_concurrency();
+	int depth = 3;
+
+	while ((1 << depth) < threadCount * 8)
+	{
+		depth++;
+	}
+
+	return depth;
+}
+
+template<class T>
+void RedBlackTree<T>::runParallel(int taskCount, const std::function<void(int)>& task)
+{
+	// hardware_concurrency is allowed to return 0 when it doesn't know
+	int threadCount = (int)std::thread::hardware_concurrency();
+
+	if (threadCount < 1)
+	{
+		threadCount = 1;
+	}
+
+	if (threadCount > taskCount)
+	{
+		threadCount = taskCount;
+	}
+
+	// every thread keeps taking the next task until there are none left
+	// so a thread that got small subtrees picks up the slack of one that got big ones
+	std::atomic<int> nextTask(0);
+
+	auto worker = [&]()
+	{
+		for (int i = nextTask++; i < taskCount; i = nextTask++)
+		{
+			task(i);
+		}
+	};
+
+	// the calling thread works as well
+	vector<std::thread> threads;
+	threads.reserve(threadCount);
+
+	for (int i = 1; i < threadCount; i++)
+	{
+		// a thread that can't be started is no error, the threads that did start
+		// and the calling thread take over its tasks
+		try
+		{
+			threads.emplace_back(worker);
+		}
+		catch (const std::system_error&)
+		{
+			break;
+		}
+	}
+
+	worker();
+
+	for (std::thread& th : threads)
+	{
+		th.join();
+	}
+}
+
+template <class T>
+NodeT<T>* RedBlackTree<T>::find(T value) const
+{
+	// the filter never says no to a value that is in the tree
+	if (filter != nullptr && !filter->mayContain(value))
+	{
+		return nullptr;
+	}
+
+	// create a traverse pointer
+	NodeT<T>* ptr = root;
+
+	// as long as the pointer is not nullptr
+	while (ptr != nullptr) 
+	{
+		// if the value is found return the pointer
+		if (value == ptr->data) 
+		{ 
+			return ptr; 
+		}
+		else if (value < ptr->data)// check if the value is less than
+		{ 
+			ptr = ptr->left; 
+		}
+		else // greater than
+		{ 
+			ptr = ptr->right; 
+		}
+
+	}
+
+	// value does not exist
+	return nullptr;
+}
+
+template <class T>
+NodeT<T>* RedBlackTree<T>::fingerDescend(NodeT<T>* finger, T value) const
+{
+	// start from the finger or the root if there is none
+	NodeT<T>* ptr = finger;
+
+	if (ptr == nullptr)
+	{
+		ptr = root;
+	}
+
+	// check if there is a tree at all
+	isNullptr(ptr, ptr);
+
+	// climb until the value is inside the range covered by ptr's subtree
+	bool climbing = true;
+
+	while (climbing)
+	{
+		// if the value is found return the pointer
+		if (value == ptr->data)
+		{
+			return ptr;
+		}
+
+		NodeT<T>* up = ptr;
+
+		if (value < ptr->data)
+		{
+			// only an ancestor we are the right child of bounds the subtree from below
+			// so skip past the ones we are the left child of
+			while (up->parent != nullptr && up == up->parent->left)
+			{
+				up = up->parent;
+			}
+
+			// if the value isn't above that bound keep climbing
+			if (up->parent != nullptr && !(up->parent->data < value))
+			{
+				ptr = up->parent;
+			}
+			else
+			{
+				climbing = false;
+			}
+		}
+		else // symmetric to the if
+		{
+			while (up->parent != nullptr && up == up->parent->right)
+			{
+				up = up->parent;
+			}
+
+			if (up->parent != nullptr && !(value < up->parent->data))
+			{
+				ptr = up->parent;
+			}
+			else
+			{
+				climbing = false;
+			}
+		}
+	}
+
+	// descend as usual and stop at the node the value would hang off of
+	while (true)
+	{
+		NodeT<T>* next;
+
+		if (value == ptr->data)
+		{
+			return ptr;
+		}
+		else if (value < ptr->data)// check if the value is less than
+		{
+			next = ptr->left;
+		}
+		else // greater than
+		{
+			next = ptr->right;
+		}
+
+		isNullptr(next, ptr);
+		ptr = next;
+	}
+}
+
+template <class T>
+void RedBlackTree<T>::valueTraversalHelper(NodeT<T>* nd, vector<T>& vec) const
+{
+	// check if the param is null if so return
+	isNullptr(nd);
+
+	// recurse the tree and push_back the values into the vector refrence param
+	valueTraversalHelper(nd->left, vec);
+
+	if (!nd->isDeleted)
+	{
+		vec.push_back(nd->data);
+	}
+
+	valueTraversalHelper(nd->right, vec);
+}
+
+template <class T>
+void  RedBlackTree<T>::searchTraversalHelper(NodeT<T>* nd, vector<T>& vec, T begin, T end) const
+{
+	// check if the param is null if so return
+	isNullptr(nd);
+
+	// recurse over the tree in the given range and puch_back the values into the vector param
+	searchTraversalHelper(nd->left, vec, begin, end);
+	if (nd->data >= begin && nd->data <= end && !nd->isDeleted)
+	{
+		vec.push_back(nd->data);
+	}
+	searchTraversalHelper(nd->right, vec, begin, end);
+}
+
+template <class T>
+void RedBlackTree<T>::rebuildFilter(int expectedSize)
+{
+	// create a bigger filter with the same rate and hash and add every value in the tree
+	CountingBloomFilter<T>* bigger = new CountingBloomFilter<T>(expectedSize, filter->falsePositiveRate(), filter->hashFunction());
+	delete filter;
+	filter = bigger;
+	filterTraversalHelper(root);
+}
+
+template <class T>
+void RedBlackTree<T>::filterTraversalHelper(NodeT<T>* nd)
+{
+	// check if the param is null if so return
+	isNullptr(nd);
+
+	// recurse the tree and add every value to the filter
+	filterTraversalHelper(nd->left);
+
+	if (!nd->isDeleted)
+	{
+		filter->add(nd->data);
+	}
+
+	filterTraversalHelper(nd->right);
+}
+
+template <class T>
+NodeT<T>* RedBlackTree<T>::lowerBound(T value) const
+{
+	// the best candidate so far
+	NodeT<T>* bound = nullptr;
+	NodeT<T>* ptr = root;
+
+	while (ptr != nullptr)
+	{
+		// go left when the node is big enough, it might be the answer
+		if (value < ptr->data)
+		{
+			bound = ptr;
+			ptr = ptr->left;
+		}
+		else if (value == ptr->data)
+		{
+			return ptr;
+		}
+		else
+		{
+			ptr = ptr->right;
+		}
+	}
+
+	return bound;
+}
+
+template <class T>
+NodeT<T>* RedBlackTree<T>::successor(NodeT<T>* nd) const
+{
+	// the smallest value in the right subtree
+	if (nd->right != nullptr)
+	{
+		nd = nd->right;
+
+		while (nd->left != nullptr)
+		{
+			nd = nd->left;
+		}
+
+		return nd;
+	}
+
+	// otherwise the first ancestor we are in the left subtree of
+	while (nd->parent != nullptr && nd == nd->parent->right)
+	{
+		nd = nd->parent;
+	}
+
+	return nd->parent;
+}
+
+template <class T>
+NodeT<T>* RedBlackTree<T>::previous(NodeT<T>* nd) const
+{
+	// symmetric to successor
+	if (nd->left != nullptr)
+	{
+		nd = nd->left;
+
+		while (nd->right != nullptr)
+		{
+			nd = nd->right;
+		}
+
+		return nd;
+	}
+
+	while (nd->parent != nullptr && nd == nd->parent->left)
+	{
+		nd = nd->parent;
+	}
+
+	return nd->parent;
+}
+
+template <class T>
+void RedBlackTree<T>::updateEnds()
+{
+	leftmost = root;
+	rightmost = root;
+
+	// check if there is a tree
+	isNullptr(root);
+
+	while (leftmost->left != nullptr)
+	{
+		leftmost = leftmost->left;
+	}
+
+	while (rightmost->right != nullptr)
+	{
+		rightmost = rightmost->right;
+	}
+}
+
+template <class T>
+NodeT<T>* RedBlackTree<T>::evictionCandidate() const
+{
+	// start at the end that is evicted from and skip the marked nodes
+	if (keepLargest)
+	{
+		NodeT<T>* nd = leftmost;
+
+		while (nd != nullptr && nd->isDeleted)
+		{
+			nd = successor(nd);
+		}
+
+		return nd;
+	}
+
+	NodeT<T>* nd = rightmost;
+
+	while (nd != nullptr && nd->isDeleted)
+	{
+		nd = previous(nd);
+	}
+
+	return nd;
+}
+
+template <class T>
+void RedBlackTree<T>::evictOverflow()
+{
+	// no bound
+	if (capacityLimit == 0)
+	{
+		return;
+	}
+
+	// splice out the cached end, marked nodes on the way are dropped as well
+	// an end has at most one child so no other node is touched or moved
+	while (currentSize > capacityLimit)
+	{
+		unlinkNode(keepLargest ? leftmost : rightmost);
+	}
+}
+
+template <class T>
+void RedBlackTree<T>::rangeRemovalHelper(NodeT<T>* nd, vector<NodeT<T>*>& keep, T begin, T end)
+{
+	// check if the param is null if so return
+	isNullptr(nd);
+
+	// grab the children first, nd might be deleted
+	NodeT<T>* leftChild = nd->left;
+	NodeT<T>* rightChild = nd->right;
+
+	rangeRemovalHelper(leftChild, keep, begin, end);
+
+	if (nd->isDeleted)
+	{
+		// the filter dropped the value when it was marked
+		freeNode(nd);
+	}
+	else if (nd->data < begin || end < nd->data)
+	{
+		keep.push_back(nd);
+	}
+	else
+	{
+		// keep the filter in sync
+		if (filter != nullptr)
+		{
+			filter->remove(nd->data);
+		}
+
+		freeNode(nd);
+	}
+
+	rangeRemovalHelper(rightChild, keep, begin, end);
+}
+
+template <class T>
+void RedBlackTree<T>::purgeTraversalHelper(NodeT<T>* nd, vector<NodeT<T>*>& keep)
+{
+	// check if the param is null if so return
+	isNullptr(nd);
+
+	// grab the children first, nd might be deleted
+	NodeT<T>* leftChild = nd->left;
+	NodeT<T>* rightChild = nd->right;
+
+	purgeTraversalHelper(leftChild, keep);
 
+	if (nd->isDeleted)
+	{
+		freeNode(nd);
+	}
+	else
+	{
+		keep.push_back(nd);
 	}
 
-	// value does not exist
-	return nullptr;
+	purgeTraversalHelper(rightChild, keep);
 }
 
 template <class T>
-void RedBlackTree<T>::valueTraversalHelper(NodeT<T>* nd, vector<T>& vec) const
+NodeT<T>* RedBlackTree<T>::buildBalanced(vector<NodeT<T>*>& nodes)
 {
-	// check if the param is null if so return
-	isNullptr(nd);
+	// count the levels that are completely full, a level below those is only partially
+	// filled so its nodes are made RED which keeps the black height the same on every path
+	int fullLevels = 0;
 
-	// recurse the tree and push_back the values into the vector refrence param
-	valueTraversalHelper(nd->left, vec);
-	vec.push_back(nd->data);
-	valueTraversalHelper(nd->right, vec);
+	while ((2 << fullLevels) - 1 <= (int)nodes.size())
+	{
+		fullLevels++;
+	}
+
+	NodeT<T>* newRoot = buildBalancedHelper(nodes, 0, (int)nodes.size(), 0, fullLevels);
+
+	// the ends of the sorted nodes are the ends of the tree
+	leftmost = nodes.empty() ? nullptr : nodes.front();
+	rightmost = nodes.empty() ? nullptr : nodes.back();
+
+	// the root has no parent
+	if (newRoot != nullptr)
+	{
+		newRoot->parent = nullptr;
+	}
+
+	return newRoot;
 }
 
 template <class T>
-void  RedBlackTree<T>::searchTraversalHelper(NodeT<T>* nd, vector<T>& vec, T begin, T end) const
+NodeT<T>* RedBlackTree<T>::buildBalancedHelper(vector<NodeT<T>*>& nodes, int first, int last, int depth, int redDepth)
 {
-	// check if the param is null if so return
-	isNullptr(nd);
+	// empty range
+	if (first >= last)
+	{
+		return nullptr;
+	}
 
-	// recurse over the tree in the given range and puch_back the values into the vector param
-	searchTraversalHelper(nd->left, vec, begin, end);
-	if (nd->data >= begin && nd->data <= end)
+	// the middle node becomes the subtree root
+	int mid = first + (last - first) / 2;
+	NodeT<T>* nd = nodes[mid];
+
+	nd->left = buildBalancedHelper(nodes, first, mid, depth + 1, redDepth);
+	nd->right = buildBalancedHelper(nodes, mid + 1, last, depth + 1, redDepth);
+	nd->isBlack = depth < redDepth;
+
+	// connect parents
+	if (nd->left != nullptr)
 	{
-		vec.push_back(nd->data);
+		nd->left->parent = nd;
 	}
-	searchTraversalHelper(nd->right, vec, begin, end);
+
+	if (nd->right != nullptr)
+	{
+		nd->right->parent = nd;
+	}
+
+	nd->update();
+
+	return nd;
 }
 
 template <class T>
@@ -611,24 +2060,242 @@ NodeT<T>* RedBlackTree<T>::predecessor(NodeT<T>* nd) const
 }
 
 template<class T>
-NodeT<T>* RedBlackTree<T>::BinaryTreeInsert(NodeT<T>* ndCurrent, NodeT<T>* newNode)
+void RedBlackTree<T>::unlinkNode(NodeT<T>* removeNode)
 {
-	// check if the param is null if so return
-	isNullptr(ndCurrent, newNode);
+	// assign other pointers to nullptr for predecessor and the predecessor's child
+	NodeT<T>* temp = nullptr;
+	NodeT<T>* tempChild = nullptr;
+
+	// checks if the removeNode has no childern
+	if (removeNode->left == nullptr || removeNode->right == nullptr)
+	{
+		temp = removeNode;
+	}
+	else 
+	{ 
+		// otherwise it has two children so we grab the predecessor
+		temp = predecessor(removeNode);
+	}
+
+	// identify if temp�s only child is right or left
+	if (temp->left != nullptr) 
+	{ 
+		tempChild = temp->left; 
+	}
+	else 
+	{ 
+		tempChild = temp->right; 
+	}
+
+	// check if temp child is not null
+	if (tempChild != nullptr)
+	{
+		// detach the tempChild from temp
+		tempChild->parent = temp->parent;
+	}
+
+	// check if temp is the root
+	if (temp->parent == nullptr) 
+	{ 
+		// make the tempChild the root
+		root = tempChild;
+	}
+	else
+	{
+		// attach tempChild to temp's parent
+		if (temp == temp->parent->left)//is left
+		{ 
+			temp->parent->left = tempChild; 
+		}
+		else // is right
+		{ 
+			temp->parent->right = tempChild;
+		}
+	}
+
+	// if temp is an end of the tree the next node in becomes the end
+	// when temp is removeNode's predecessor removeNode takes over its value and so its place
+	if (temp == leftmost)
+	{
+		if (temp != removeNode)
+		{
+			leftmost = removeNode;
+		}
+		else if (tempChild != nullptr)
+		{
+			leftmost = tempChild;
+
+			while (leftmost->left != nullptr)
+			{
+				leftmost = leftmost->left;
+			}
+		}
+		else
+		{
+			leftmost = temp->parent;
+		}
+	}
+
+	// the predecessor is never the largest so here temp is removeNode
+	if (temp == rightmost)
+	{
+		if (tempChild != nullptr)
+		{
+			rightmost = tempChild;
+
+			while (rightmost->right != nullptr)
+			{
+				rightmost = rightmost->right;
+			}
+		}
+		else
+		{
+			rightmost = temp->parent;
+		}
+	}
+
+	// a marked node was taken off the size and the filter already
+	if (removeNode->isDeleted)
+	{
+		tombstones--;
+	}
+	else
+	{
+		// decrease the tree size
+		currentSize--;
+
+		// keep the filter in sync before removeNode's value is overwritten
+		if (filter != nullptr)
+		{
+			filter->remove(removeNode->data);
+		}
+	}
+
+	// if temp and removeNode aren't the same
+	if (temp != removeNode)
+	{
+		// replace removeNode data with the temp data, along with its mark
+		removeNode->data = temp->data;
+		removeNode->isDeleted = temp->isDeleted;
+	}
+
+	// everything from temp's parent up, which includes removeNode, lost or changed a value
+	if (NodeAugment<T>::augmented)
+	{
+		updatePath(temp->parent);
+	}
+
+	// checks if the temp is black, if so call the fix for removal method
+	if (temp->isBlack == true) 
+	{ 
+		fixRemovalRBT(tempChild, temp->parent); 
+	}
+
+	// delete the temp
+	freeNode(temp);
+}
+
+template<class T>
+void RedBlackTree<T>::fixInsertRBT(NodeT<T>* newNode)
+{
+	// if the newNode is not the root and it's parent colour is RED
+	// this will iterate until the root or a black parent is reached
+	while (newNode != root && newNode->parent->isBlack == false)
+	{
+		// Set the Grandparent of the NewNode
+		NodeT<T>* grandParent = newNode->parent->parent;
+
+		// checks if the newNode parent is a left child
+		if (newNode->parent == grandParent->left)
+		{
+			// "uncle" of newNode
+			NodeT<T>* uncle = grandParent->right;
+
+			if (uncle != nullptr && uncle->isBlack == false)
+			{
+				/* 
+				The uncle and newNodes�s parent are both red so they can be
+				made black, and newNodes�s grandparent can be made
+				red, then make the newNode the grandparentand repeat
+				*/
+				newNode->parent->isBlack = true;
+				uncle->isBlack = true;
+				grandParent->isBlack = false;
+				newNode = grandParent;
+			}
+			else
+			{
+				/*
+				The newNodes�s grandparent must be black,
+				arrange newNode and parent in a line,
+				rotate newNode�s grandparent to
+				balance the tree, and fix the
+				colours
+				*/
+				if (newNode == newNode->parent->right)
+				{
+					newNode = newNode->parent;
+					rotateLeft(newNode);
+				}
+				newNode->parent->isBlack = true;
+				grandParent->isBlack = false;
+				rotateRight(grandParent);
+			}
+		}
+		else // symmetric to the if
+		{
+			NodeT<T>* uncle = grandParent->left;
 
-	// recursively add the node into the tree
-	if (newNode->data < ndCurrent->data)
+			if (uncle != nullptr && uncle->isBlack == false)
+			{
+				newNode->parent->isBlack = true;
+				uncle->isBlack = true;
+				grandParent->isBlack = false;
+				newNode = grandParent;
+			}
+			else
+			{
+				if (newNode == newNode->parent->left)
+				{
+					newNode = newNode->parent;
+					rotateRight(newNode);
+				}
+				newNode->parent->isBlack = true;
+				grandParent->isBlack = false;
+				rotateLeft(grandParent);
+			}
+		}
+	}
+
+	// if the root set it to black
+	root->isBlack = true;
+}
+
+template<class T>
+void RedBlackTree<T>::updatePath(NodeT<T>* nd)
+{
+	// walk up to the root
+	while (nd != nullptr)
 	{
-		ndCurrent->left = BinaryTreeInsert(ndCurrent->left, newNode);
-		ndCurrent->left->parent = ndCurrent;
+		nd->update();
+		nd = nd->parent;
 	}
-	else if (newNode->data > ndCurrent->data)
+}
+
+template<class T>
+void RedBlackTree<T>::updateTopHelper(NodeT<T>* nd, int depth)
+{
+	// check if the param is null if so return
+	isNullptr(nd);
+
+	// children first, below depth everything is up to date already
+	if (depth > 0)
 	{
-		ndCurrent->right = BinaryTreeInsert(ndCurrent->right, newNode);
-		ndCurrent->right->parent = ndCurrent;
+		updateTopHelper(nd->left, depth - 1);
+		updateTopHelper(nd->right, depth - 1);
 	}
 
-	return ndCurrent;
+	nd->update();
 }
 
 template<class T>
@@ -765,6 +2432,10 @@ void RedBlackTree<T>::rotateRight(NodeT<T>* nd)
 	// connect the nodes
 	parentNode->right = nd;
 	nd->parent = parentNode;
+
+	// nd is below parentNode now so it is updated first
+	nd->update();
+	parentNode->update();
 }
 
 
@@ -798,6 +2469,211 @@ void RedBlackTree<T>::rotateLeft(NodeT<T>* nd)
 
 	parentNode->left = nd;
 	nd->parent = parentNode;
+
+	nd->update();
+	parentNode->update();
+}
+
+// --CountingBloomFilter ===========================================================================
+
+template<class T>
+CountingBloomFilter<T>::CountingBloomFilter(int expectedSize, double falsePositiveRate, HashFunction hashFunction)
+{
+	hasher = hashFunction;
+
+	// fall back to 1% if the rate makes no sense
+	if (!(falsePositiveRate > 0.0 && falsePositiveRate < 1.0))
+	{
+		falsePositiveRate = 0.01;
+	}
+
+	// don't bother with tiny filters
+	if (expectedSize < 64)
+	{
+		expectedSize = 64;
+	}
+
+	expected = expectedSize;
+	targetRate = falsePositiveRate;
+
+	// start from the usual sizing, m = -n ln(p) / ln(2)^2 slots
+	const double ln2 = std::log(2.0);
+	double slots = std::ceil(-expectedSize * std::log(falsePositiveRate) / (ln2 * ln2));
+	blockCount = ((size_t)slots + 63) / 64;
+
+	// blocks that get more than their share of values raise the rate, so grow the filter
+	// until the best number of hashes for its size is back at the target rate
+	bool sized = false;
+
+	while (!sized)
+	{
+		double perBlock = (double)expectedSize / blockCount;
+		double bestRate = 1.0;
+
+		for (int hashes = 1; hashes <= 16; hashes++)
+		{
+			double rate = blockedRate(perBlock, hashes);
+
+			if (rate < bestRate)
+			{
+				bestRate = rate;
+				hashCount = hashes;
+			}
+		}
+
+		if (bestRate <= falsePositiveRate)
+		{
+			sized = true;
+		}
+		else
+		{
+			blockCount += blockCount / 16 + 1;
+		}
+	}
+
+	// whole blocks, plus the bytes needed to align the first one
+	counters.assign(blockCount * 64 + 63, 0);
+}
+
+template<class T>
+void CountingBloomFilter<T>::add(const T& value)
+{
+	uint64_t hash = hashValue(value);
+	size_t start = blockStart(hash);
+
+	// bump every counter, a full counter stays full
+	for (int i = 0; i < hashCount; i++)
+	{
+		unsigned char& counter = counters[start + blockSlot(hash, i)];
+
+		if (counter != 255)
+		{
+			counter++;
+		}
+	}
+}
+
+template<class T>
+void CountingBloomFilter<T>::remove(const T& value)
+{
+	uint64_t hash = hashValue(value);
+	size_t start = blockStart(hash);
+
+	// drop every counter, a full counter has lost track of its count so it is left alone
+	for (int i = 0; i < hashCount; i++)
+	{
+		unsigned char& counter = counters[start + blockSlot(hash, i)];
+
+		if (counter != 0 && counter != 255)
+		{
+			counter--;
+		}
+	}
+}
+
+template<class T>
+bool CountingBloomFilter<T>::mayContain(const T& value) const
+{
+	uint64_t hash = hashValue(value);
+	size_t start = blockStart(hash);
+
+	// a single empty counter means the value was never added
+	for (int i = 0; i < hashCount; i++)
+	{
+		if (counters[start + blockSlot(hash, i)] == 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template<class T>
+double CountingBloomFilter<T>::falsePositiveRate() const
+{
+	return targetRate;
+}
+
+template<class T>
+int CountingBloomFilter<T>::capacity() const
+{
+	return expected;
+}
+
+template<class T>
+typename CountingBloomFilter<T>::HashFunction CountingBloomFilter<T>::hashFunction() const
+{
+	return hasher;
+}
+
+template<class T>
+size_t CountingBloomFilter<T>::standardHash(const T& value)
+{
+	return std::hash<T>()(value);
+}
+
+template<class T>
+size_t CountingBloomFilter<T>::memoryUsage() const
+{
+	return counters.capacity();
+}
+
+template<class T>
+uint64_t CountingBloomFilter<T>::hashValue(const T& value) const
+{
+	// std::hash is the identity for integers so run the hash through the splitmix64 finalizer
+	uint64_t hash = (uint64_t)hasher(value);
+	hash ^= hash >> 30;
+	hash *= 0xbf58476d1ce4e5b9ULL;
+	hash ^= hash >> 27;
+	hash *= 0x94d049bb133111ebULL;
+	hash ^= hash >> 31;
+	return hash;
+}
+
+template<class T>
+double CountingBloomFilter<T>::blockedRate(double perBlock, int hashes)
+{
+	// chance a block holds j values, starting at j = 0
+	double blockChance = std::exp(-perBlock);
+	double rate = 0.0;
+
+	// a block with j values has each slot set with chance 1 - (1 - 1/64)^(hashes * j)
+	// and a false positive needs all hashes slots set
+	int last = (int)(perBlock * 4) + 64;
+
+	for (int j = 0; j <= last; j++)
+	{
+		if (j > 0)
+		{
+			blockChance *= perBlock / j;
+		}
+
+		double slotSet = 1.0 - std::pow(63.0 / 64.0, (double)hashes * j);
+		rate += blockChance * std::pow(slotSet, hashes);
+	}
+
+	return rate;
+}
+
+template<class T>
+size_t CountingBloomFilter<T>::blockStart(uint64_t hash) const
+{
+	// the counters are copied with the filter so the alignment is worked out each time
+	size_t offset = (64 - (size_t)((uintptr_t)counters.data() % 64)) % 64;
+
+	// the low half picks the block
+	return offset + (size_t)((hash & 0xffffffffULL) % blockCount) * 64;
+}
+
+template<class T>
+size_t CountingBloomFilter<T>::blockSlot(uint64_t hash, int i) const
+{
+	// 64 slots leave too few bits for double hashing to spread the values well,
+	// so every hash gets its own multiply and the top 6 bits of the product
+	uint64_t mixed = (hash ^ ((uint64_t)(i + 1) * 0x9e3779b97f4a7c15ULL)) * 0xbf58476d1ce4e5b9ULL;
+	return (size_t)(mixed >> 58);
 }
 
 //======================================================================================================
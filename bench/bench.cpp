@@ -0,0 +1,148 @@
+// benchmark for the README's RedBlackTree vs BPlusTree table
+//
+// build and run from the repository root, one structure per process so the heap starts fresh each time:
+//   g++ -std=c++11 -O2 -o bench/bench bench/bench.cpp
+//   for i in 0 1 2 3; do ./bench/bench 4000000 $i; done
+//
+// --PARAM: argv[1] is the number of keys (default 4000000), argv[2] picks the structure:
+// 0 RedBlackTree<double>, 1 BPlusTree<double>, 2 RedBlackTree<int64_t>, 3 BPlusTree<int64_t>, anything else runs all four
+//
+// the keys are the same for every structure, distinct even integers in [0, 2^41) in random order,
+// the double trees hold the same numbers converted, which is exact, so the trees have the same
+// shape and only the comparisons differ
+//
+// every column is the wall clock time of one loop divided by the number of operations in it
+// insert:      inserting every key in its random order into an empty tree
+// search hit:  1,000,000 search(value) calls for keys in the tree, in shuffled order
+// search miss: 1,000,000 search(value) calls for random odd integers, which are never in the tree
+// remove:      200,000 remove(value) calls for keys in the tree, in shuffled order, run last
+// range:       20 search(begin, end) calls over [key, key + 2^27], a few hundred values each
+// values():    one values() call divided by the number of values
+// bytes:       bytes asked from operator new while inserting, divided by the number of keys,
+//              the allocator's own overhead isn't included
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include "../RedBlackTree.h"
+#include "../BPlusTree.h"
+
+// bytes handed out by operator new, the benchmark is single threaded
+static size_t allocatedBytes = 0;
+
+void* operator new(size_t bytes)
+{
+	allocatedBytes += bytes;
+
+	void* ptr = std::malloc(bytes == 0 ? 1 : bytes);
+
+	if (ptr == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+
+// returns the nanoseconds per operation of calling work once
+template<class Work>
+double nanosPerOp(Work work, size_t operations)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	work();
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+	return elapsed.count() / operations;
+}
+
+// runs every measurement on one structure and prints a table row
+template<class T, class Tree>
+void run(const char* name, const vector<int64_t>& keys, const vector<int64_t>& misses)
+{
+	// convert the keys to the value type first so the conversion isn't timed
+	vector<T> values(keys.begin(), keys.end());
+	vector<T> missValues(misses.begin(), misses.end());
+
+	// the lookups go in a different order than the inserts
+	vector<T> queries(values);
+	std::shuffle(queries.begin(), queries.end(), std::mt19937(9));
+	queries.resize(std::min<size_t>(queries.size(), 1000000));
+
+	// sum every result so the compiler can't drop the loops
+	long checksum = 0;
+
+	Tree tree;
+	size_t before = allocatedBytes;
+
+	double insertTime = nanosPerOp([&]() { for (const T& v : values) checksum += tree.insert(v); }, values.size());
+
+	double bytesPerValue = (double)(allocatedBytes - before) / values.size();
+
+	double hitTime = nanosPerOp([&]() { for (const T& v : queries) checksum += tree.search(v); }, queries.size());
+
+	double missTime = nanosPerOp([&]() { for (const T& v : missValues) checksum += tree.search(v); }, missValues.size());
+
+	const int rangeCount = 20;
+	double rangeTime = nanosPerOp([&]()
+	{
+		for (int i = 0; i < rangeCount; i++)
+		{
+			checksum += tree.search(queries[i], queries[i] + (T)(1 << 27)).size();
+		}
+	}, rangeCount);
+
+	double valuesTime = nanosPerOp([&]() { checksum += tree.values().size(); }, values.size());
+
+	size_t removeCount = std::min<size_t>(queries.size(), 200000);
+	double removeTime = nanosPerOp([&]() { for (size_t i = 0; i < removeCount; i++) checksum += tree.remove(queries[i]); }, removeCount);
+
+	printf("| `%s` | %.0f | %.0f | %.0f | %.0f | %.0f | %.1f | %.1f |   (checksum %ld)\n",
+		name, insertTime, hitTime, missTime, removeTime, rangeTime, valuesTime, bytesPerValue, checksum);
+}
+
+int main(int argc, char** argv)
+{
+	int count = argc > 1 ? atoi(argv[1]) : 4000000;
+	int which = argc > 2 ? atoi(argv[2]) : -1;
+
+	// distinct even keys in random order and odd keys that are never in the tree
+	std::mt19937_64 rng(1);
+	vector<int64_t> keys;
+	vector<int64_t> misses;
+
+	for (int i = 0; i < count; i++)
+	{
+		keys.push_back(2 * (int64_t)(rng() % (1ULL << 40)));
+	}
+
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+	std::shuffle(keys.begin(), keys.end(), rng);
+
+	for (int i = 0; i < 1000000; i++)
+	{
+		misses.push_back(2 * (int64_t)(rng() % (1ULL << 40)) + 1);
+	}
+
+	printf("%d keys\n", (int)keys.size());
+	printf("| | insert | search hit | search miss | remove | range | values() per value | bytes per value |\n");
+	printf("|---|---|---|---|---|---|---|---|\n");
+
+	if (which == 0 || which < 0 || which > 3) run<double, RedBlackTree<double>>("RedBlackTree<double>", keys, misses);
+	if (which == 1 || which < 0 || which > 3) run<double, BPlusTree<double>>("BPlusTree<double>", keys, misses);
+	if (which == 2 || which < 0 || which > 3) run<int64_t, RedBlackTree<int64_t>>("RedBlackTree<int64_t>", keys, misses);
+	if (which == 3 || which < 0 || which > 3) run<int64_t, BPlusTree<int64_t>>("BPlusTree<int64_t>", keys, misses);
+
+	return 0;
+}
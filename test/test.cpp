@@ -0,0 +1,250 @@
+// randomized check of RedBlackTree against std::set, along with the tree's own bookkeeping
+//
+// build and run from the repository root, the sanitizers are optional but catch the most:
+//   g++ -std=c++17 -O1 -g -fsanitize=address,undefined -o test/test test/test.cpp
+//   ./test/test
+//
+// --PARAM: argv[1] is the random seed (default 1), argv[2] the number of operations per round (default 200000)
+//
+// after every batch of operations it checks
+// the tree:   order, parent links, a black root, no red node with a red child and equal black heights
+// the counts: size() and deletedCount() against the nodes that are and aren't marked as deleted
+// the ends:   leftmost and rightmost against the smallest and largest node
+// the arena:  every free slot is inside the arena, listed once and not used by a node, and the
+//             arena's nodes plus its free slots add up to its capacity
+// the values: values() against the std::set
+// while mixing insert, finger insert, remove, range remove, compact, lazy deletion, purge and a capacity bound
+
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <random>
+#include <iterator>
+#include "../RedBlackTree.h"
+
+// stop on the first failed check, unlike assert this also works in a release build
+#define check(x, message) if (!(x)) { printf("check failed: %s (%s:%d)\n", message, __FILE__, __LINE__); exit(1); }
+
+// a tree that can look at its own bookkeeping
+template<class T>
+class CheckedTree : public RedBlackTree<T>
+{
+public:
+
+	// checks every invariant, the node count the tree reports has to match its nodes
+	void verify(const std::set<T>& expected)
+	{
+		check(this->root == nullptr || this->root->parent == nullptr, "root has a parent");
+		check(this->root == nullptr || this->root->isBlack, "root is red");
+
+		int live = 0;
+		int marked = 0;
+		vector<NodeT<T>*> nodes;
+		verifyHelper(this->root, nullptr, live, marked, nodes);
+
+		check(live == this->size(), "size() doesn't match the live nodes");
+		check(marked == this->deletedCount(), "deletedCount() doesn't match the marked nodes");
+
+		// nodes come out in order so the ends are the first and last one
+		check(this->leftmost == (nodes.empty() ? nullptr : nodes.front()), "leftmost isn't the smallest node");
+		check(this->rightmost == (nodes.empty() ? nullptr : nodes.back()), "rightmost isn't the largest node");
+
+		// every free slot is in the arena, once, and not in use
+		std::set<NodeT<T>*> freeSlots(this->freeSlots.begin(), this->freeSlots.end());
+		check(freeSlots.size() == this->freeSlots.size(), "a free slot is listed twice");
+
+		for (NodeT<T>* slot : this->freeSlots)
+		{
+			check(this->inArena(slot), "a free slot is outside the arena");
+		}
+
+		int arenaNodes = 0;
+
+		for (NodeT<T>* nd : nodes)
+		{
+			if (this->inArena(nd))
+			{
+				arenaNodes++;
+				check(freeSlots.count(nd) == 0, "a node sits in a free slot");
+			}
+		}
+
+		check(arenaNodes + (int)this->freeSlots.size() == this->arenaCapacity, "arena nodes and free slots don't add up");
+		check(this->arena != nullptr || this->arenaCapacity == 0, "capacity without an arena");
+
+		// and the values themselves
+		vector<T> values = this->values();
+		check(values == vector<T>(expected.begin(), expected.end()), "values() doesn't match std::set");
+	}
+
+private:
+
+	// recursive function to check the subtree and return its black height
+	int verifyHelper(NodeT<T>* nd, NodeT<T>* parent, int& live, int& marked, vector<NodeT<T>*>& nodes)
+	{
+		isNullptr(nd, 1);
+
+		check(nd->parent == parent, "wrong parent link");
+		check(nd->isBlack || parent == nullptr || parent->isBlack, "red node with a red child");
+		check(nd->left == nullptr || nd->left->data < nd->data, "left child isn't smaller");
+		check(nd->right == nullptr || nd->data < nd->right->data, "right child isn't larger");
+
+		int leftHeight = verifyHelper(nd->left, nd, live, marked, nodes);
+
+		nodes.push_back(nd);
+
+		if (nd->isDeleted)
+		{
+			marked++;
+		}
+		else
+		{
+			live++;
+		}
+
+		int rightHeight = verifyHelper(nd->right, nd, live, marked, nodes);
+
+		check(leftHeight == rightHeight, "black heights differ");
+
+		return leftHeight + (nd->isBlack ? 1 : 0);
+	}
+};
+
+// what the bounded tree does, on the std::set side
+bool boundedInsert(std::set<int>& expected, int value, int capacity, bool keepLargest)
+{
+	if (expected.count(value) != 0)
+	{
+		return false;
+	}
+
+	// a full set only takes a value that beats the one it would evict
+	if (capacity > 0 && (int)expected.size() >= capacity)
+	{
+		if (keepLargest ? value < *expected.begin() : *expected.rbegin() < value)
+		{
+			return false;
+		}
+	}
+
+	expected.insert(value);
+
+	while (capacity > 0 && (int)expected.size() > capacity)
+	{
+		expected.erase(keepLargest ? expected.begin() : std::prev(expected.end()));
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned seed = argc > 1 ? (unsigned)atoi(argv[1]) : 1;
+	int operations = argc > 2 ? atoi(argv[2]) : 200000;
+
+	std::mt19937 rng(seed);
+
+	// every round turns on a different mix of features
+	for (int round = 0; round < 8; round++)
+	{
+		CheckedTree<int> tree;
+		std::set<int> expected;
+
+		bool lazy = (round & 1) != 0;
+		bool bounded = (round & 2) != 0;
+		bool keepLargest = (round & 4) != 0;
+		int capacity = bounded ? 500 : 0;
+
+		if (lazy)
+		{
+			tree.enableLazyDeletion(true, 0.2);
+		}
+
+		if (bounded)
+		{
+			tree.setCapacity(capacity, keepLargest);
+		}
+
+		NodeT<int>* finger = nullptr;
+
+		for (int i = 0; i < operations; i++)
+		{
+			int value = (int)(rng() % 10000);
+			int op = (int)(rng() % 100);
+
+			if (op < 45)
+			{
+				check(tree.insert(value) == boundedInsert(expected, value, capacity, keepLargest), "insert");
+			}
+			else if (op < 55)
+			{
+				// evictions and removes can free the finger's node so start over from the root
+				finger = nullptr;
+				check(tree.insert(value, finger) == boundedInsert(expected, value, capacity, keepLargest), "finger insert");
+			}
+			else if (op < 93)
+			{
+				check(tree.remove(value) == (expected.erase(value) == 1), "remove");
+			}
+			else if (op < 95)
+			{
+				int end = value + (int)(rng() % 300);
+				int removed = 0;
+
+				for (std::set<int>::iterator it = expected.lower_bound(value); it != expected.end() && *it <= end; )
+				{
+					it = expected.erase(it);
+					removed++;
+				}
+
+				check(tree.remove(value, end) == removed, "range remove");
+			}
+			else if (op < 97)
+			{
+				tree.compact();
+			}
+			else if (op < 98)
+			{
+				tree.purge();
+				check(tree.deletedCount() == 0, "purge left marked nodes");
+			}
+			else if (op < 99)
+			{
+				check(tree.search(value) == (expected.count(value) == 1), "search");
+			}
+			else
+			{
+				// move the bound, a smaller one evicts right away
+				if (bounded)
+				{
+					capacity = 200 + (int)(rng() % 1000);
+					tree.setCapacity(capacity, keepLargest);
+
+					while ((int)expected.size() > capacity)
+					{
+						expected.erase(keepLargest ? expected.begin() : std::prev(expected.end()));
+					}
+				}
+			}
+
+			if (i % 1000 == 0)
+			{
+				tree.verify(expected);
+			}
+		}
+
+		tree.verify(expected);
+
+		// a copy gets its own heap nodes and the same values
+		CheckedTree<int> copy(tree);
+		copy.verify(expected);
+		copy.compact();
+		copy.verify(expected);
+
+		printf("round %d: %d values, %d marked\n", round, tree.size(), tree.deletedCount());
+	}
+
+	printf("all checks passed\n");
+
+	return 0;
+}